@@ -16,12 +16,17 @@ void AssetManager::destroy()
 
 AssetManager::~AssetManager()
 {
-    std::lock_guard lock(asset_map_lock);
-    for (auto& item : assets)
-        delete item.second;
+    {
+        std::unique_lock lock(pending_loads_lock);
+        pending_loads_condition.wait(lock, [this] { return pending_loads == 0; });
+    }
 
-    std::lock_guard lock2(dirty_assets_lock);
-    assets_to_delete.clear();
+    // Removed assets can still be referenced : delete everything that owns a slot
+    for (uint32_t i = 0; i < slot_count; ++i)
+        delete get_slot(i).asset.exchange(nullptr);
+
+    for (auto& chunk : slot_chunks)
+        delete[] chunk.exchange(nullptr);
 }
 
 void AssetManager::remove(IAssetPtr* asset_reference)
@@ -29,51 +34,233 @@ void AssetManager::remove(IAssetPtr* asset_reference)
     if (!asset_reference || !*asset_reference)
         return;
 
-    std::lock_guard lock(asset_map_lock);
-    auto            found_asset = assets.find(asset_reference->id());
-    AssetBase*      asset_ptr   = found_asset->second;
-    assets.erase(found_asset);
-    if (!asset_ptr)
+    AssetSlot* slot = assets.erase(asset_reference->id()());
+    if (!slot)
     {
         LOG_ERROR("error : referenced asset %s is NULL", asset_reference->id().to_string().c_str());
         return;
     }
-    std::lock_guard lock2(dirty_assets_lock);
-    assets_to_delete.push_back(asset_ptr);
+    // Existing handles are now stale : they release the asset the next time they are used. The state is published by the generation increment
+    slot->load_state.store(AssetLoadState::Missing, std::memory_order_relaxed);
+    slot->generation.fetch_add(1, std::memory_order_release);
+    release_reference(slot->index);
 }
 
-AssetBase* AssetManager::find(const AssetId& id)
+AssetBase* AssetManager::find(const AssetId& id) const
 {
-    std::lock_guard<std::mutex> lock(asset_map_lock);
-    auto                        asset = assets.find(id);
-    if (asset == assets.end())
+    const AssetSlot* slot = assets.find(id());
+    if (!slot)
+        return nullptr;
+
+    // The asset can be removed and its slot recycled meanwhile : both require a generation increment
+    const uint32_t generation = slot->generation.load(std::memory_order_acquire);
+    AssetBase*     asset      = slot->asset.load(std::memory_order_acquire);
+    if (slot->asset_id.load(std::memory_order_acquire) != id() || slot->generation.load(std::memory_order_acquire) != generation)
         return nullptr;
-    return asset->second;
+    return asset;
+}
+
+AssetLoadState AssetManager::get_load_state(const AssetId& id) const
+{
+    // Only constructed assets are published
+    if (find(id))
+        return AssetLoadState::Ready;
+    return exists(id) ? AssetLoadState::Loading : AssetLoadState::Missing;
 }
 
 std::unordered_map<AssetId, AssetBase*> AssetManager::get_assets()
 {
-    std::lock_guard lock(asset_map_lock);
-    return assets;
+    std::unordered_map<AssetId, AssetBase*> asset_copy;
+    asset_copy.reserve(assets.size());
+    assets.for_each([&](uint64_t id, AssetSlot* slot) { asset_copy.emplace(AssetId(id), slot->asset.load(std::memory_order_acquire)); });
+    return asset_copy;
 }
 
 void AssetManager::try_delete_dirty_items()
 {
-    std::lock_guard         lock(dirty_assets_lock);
-    std::vector<AssetBase*> deleted_assets;
-    for (const auto& asset : assets_to_delete)
+    // Deleting an asset can release the last reference of another one : don't hold the lock while deleting
+    std::vector<uint32_t> pending_slots;
+    {
+        std::lock_guard lock(dirty_assets_lock);
+        if (unreferenced_slots.empty())
+            return;
+        pending_slots.swap(unreferenced_slots);
+    }
+
+    std::erase_if(pending_slots,
+                  [&](uint32_t index)
+                  {
+                      AssetBase* asset = get_slot(index).asset.load(std::memory_order_relaxed);
+                      if (!asset->try_delete())
+                          return false;
+                      on_delete_asset.execute(asset);
+                      asset->on_delete_asset.execute(asset);
+                      delete asset;
+                      free_slot(index);
+                      return true;
+                  });
+
+    if (!pending_slots.empty())
+    {
+        std::lock_guard lock(dirty_assets_lock);
+        unreferenced_slots.insert(unreferenced_slots.end(), pending_slots.begin(), pending_slots.end());
+    }
+}
+
+void AssetManager::dispatch_load_callbacks()
+{
+    std::vector<LoadCallback> callbacks;
+    {
+        std::lock_guard lock(load_lock);
+        if (completed_load_callbacks.empty())
+            return;
+        callbacks.swap(completed_load_callbacks);
+    }
+
+    for (const auto& callback : callbacks)
+    {
+        if (!callback.asset)
+        {
+            callback.function(nullptr);
+            continue;
+        }
+        const bool is_ready = get_slot(callback.asset->slot_index).load_state.load(std::memory_order_acquire) == AssetLoadState::Ready;
+        callback.function(is_ready ? callback.asset : nullptr);
+        release_reference(callback.asset->slot_index);
+    }
+}
+
+void AssetManager::finish_loading(AssetBase* asset, bool succeeded)
+{
+    const AssetId id   = asset->get_id();
+    AssetSlot&    slot = get_slot(asset->slot_index);
+
+    std::lock_guard lock(load_lock);
+    if (succeeded)
+    {
+        slot.load_state.store(AssetLoadState::Ready, std::memory_order_release);
+        assets.publish(id(), &slot);
+    }
+    else
+    {
+        LOG_ERROR("failed to load asset %s", id.to_string().c_str());
+        slot.load_state.store(AssetLoadState::Failed, std::memory_order_release);
+        assets.erase(id());
+        // Existing handles are now stale : they resolve again to an asset recreated with the same id
+        slot.generation.fetch_add(1, std::memory_order_release);
+    }
+
+    if (!waiting_load_callbacks.empty())
     {
-        if (asset->try_delete())
-            deleted_assets.emplace_back(asset);
+        if (const auto waiting = waiting_load_callbacks.find(id); waiting != waiting_load_callbacks.end())
+        {
+            for (auto& callback : waiting->second)
+            {
+                slot.references.fetch_add(1, std::memory_order_relaxed);
+                completed_load_callbacks.emplace_back(LoadCallback{.asset = asset, .function = std::move(callback)});
+            }
+            waiting_load_callbacks.erase(waiting);
+        }
     }
 
-    for (const auto& asset : deleted_assets)
+    // Handles to a failed asset keep it alive. It is deleted with the last one
+    if (!succeeded)
+        release_reference(asset->slot_index);
+}
+
+void AssetManager::finish_async_loading(AssetBase* asset, bool succeeded)
+{
+    finish_loading(asset, succeeded);
+
+    // Notified under the lock : the destructor can't return before the notification is done
+    std::lock_guard lock(pending_loads_lock);
+    if (--pending_loads == 0)
+        pending_loads_condition.notify_all();
+}
+
+void AssetManager::add_load_callback(const AssetId& id, std::function<void(AssetBase*)> callback)
+{
+    std::lock_guard lock(load_lock);
+    uint32_t        generation;
+    if (const AssetSlot* slot = assets.find(id()); slot && try_acquire(*slot, id, generation))
+        completed_load_callbacks.emplace_back(LoadCallback{.asset = slot->asset.load(std::memory_order_acquire), .function = std::move(callback)});
+    else if (exists(id))
+        waiting_load_callbacks[id].emplace_back(std::move(callback));
+    else
+        completed_load_callbacks.emplace_back(LoadCallback{.asset = nullptr, .function = std::move(callback)});
+}
+
+uint32_t AssetManager::allocate_slot(AssetBase* asset, const AssetId& id, AssetLoadState load_state)
+{
+    std::lock_guard lock(slot_lock);
+    uint32_t        index;
+    if (!free_slots.empty())
     {
-        on_delete_asset.execute(asset);
-        asset->on_delete_asset.execute(asset);
-        delete asset;
-        assets_to_delete.erase(std::find(assets_to_delete.begin(), assets_to_delete.end(), asset));
+        index = free_slots.back();
+        free_slots.pop_back();
     }
+    else
+    {
+        if (slot_count == SLOT_CHUNK_SIZE * MAX_SLOT_CHUNKS)
+            LOG_FATAL("too many assets (max=%u)", SLOT_CHUNK_SIZE * MAX_SLOT_CHUNKS);
+        index = slot_count++;
+        if (index % SLOT_CHUNK_SIZE == 0)
+        {
+            AssetSlot* chunk = new AssetSlot[SLOT_CHUNK_SIZE];
+            for (uint32_t i = 0; i < SLOT_CHUNK_SIZE; ++i)
+                chunk[i].index = index + i;
+            slot_chunks[index / SLOT_CHUNK_SIZE].store(chunk, std::memory_order_release);
+        }
+    }
+
+    AssetSlot& slot = get_slot(index);
+    slot.references.store(1, std::memory_order_relaxed);
+    slot.asset_id.store(id(), std::memory_order_relaxed);
+    slot.load_state.store(load_state, std::memory_order_relaxed);
+    slot.asset.store(asset, std::memory_order_release);
+    return index;
+}
+
+void AssetManager::free_slot(uint32_t index)
+{
+    get_slot(index).asset.store(nullptr, std::memory_order_relaxed);
+    get_slot(index).load_state.store(AssetLoadState::Missing, std::memory_order_relaxed);
+    std::lock_guard lock(slot_lock);
+    free_slots.emplace_back(index);
+}
+
+bool AssetManager::try_add_reference(uint32_t index) const
+{
+    std::atomic_uint32_t& references = get_slot(index).references;
+    uint32_t              count      = references.load(std::memory_order_relaxed);
+    while (count != 0)
+        if (references.compare_exchange_weak(count, count + 1, std::memory_order_relaxed))
+            return true;
+    return false;
+}
+
+bool AssetManager::try_acquire(const AssetSlot& slot, const AssetId& id, uint32_t& out_generation)
+{
+    out_generation = slot.generation.load(std::memory_order_acquire);
+    if (!try_add_reference(slot.index))
+        return false;
+
+    // Referenced : the slot can't be recycled anymore. Check it was not before, and that the asset was not removed or failed to load
+    const AssetLoadState load_state = slot.load_state.load(std::memory_order_acquire);
+    if (slot.asset_id.load(std::memory_order_relaxed) == id() && (load_state == AssetLoadState::Loading || load_state == AssetLoadState::Ready) &&
+        slot.generation.load(std::memory_order_acquire) == out_generation)
+        return true;
+
+    release_reference(slot.index);
+    return false;
+}
+
+void AssetManager::release_reference(uint32_t index)
+{
+    if (get_slot(index).references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+    std::lock_guard lock(dirty_assets_lock);
+    unreferenced_slots.emplace_back(index);
 }
 
 void AssetManager::set(std::shared_ptr<AssetManager> in_asset_manager)
@@ -81,14 +268,14 @@ void AssetManager::set(std::shared_ptr<AssetManager> in_asset_manager)
     asset_manager_instance = in_asset_manager;
 }
 
-std::shared_ptr<AssetManager> AssetManager::get_internal()
+AssetManager* AssetManager::get_internal()
 {
     if (!asset_manager_instance)
     {
         LOG_ERROR("cannot get asset manager instance while it has not been created");
         return nullptr;
     }
-    return asset_manager_instance;
+    return asset_manager_instance.get();
 }
 
 std::string AssetBase::to_string() const
@@ -124,18 +311,20 @@ AssetBase::~AssetBase()
     asset_id = nullptr;
 }
 
-void AssetBase::internal_constructor(const AssetId& id)
+void AssetBase::internal_constructor(const AssetId& id, uint32_t in_slot_index)
 {
-    asset_id = new AssetId(id);
+    asset_id   = new AssetId(id);
+    slot_index = in_slot_index;
 }
 
 AssetId AssetManager::find_valid_asset_id(const std::string& asset_name)
 {
-    if (!find(asset_name))
+    // Assets still loading are not found but their id is already used
+    if (!exists(asset_name))
         return asset_name;
 
     int asset_index = 1;
-    while (find(asset_name + "_" + std::to_string(asset_index)))
+    while (exists(asset_name + "_" + std::to_string(asset_index)))
     {
         asset_index++;
     }
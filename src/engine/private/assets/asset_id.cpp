@@ -1,46 +1,46 @@
-
 #include "assets/asset_id.h"
 
-#include "jobSystem/job.h"
+#include "memory_tracker.h"
+#include "types/concurrent_ptr_map.h"
 
-std::size_t std::hash<AssetId>::operator()(const AssetId& other) const noexcept
-{
-    using std::hash;
-    using std::size_t;
-    using std::string;
+#include <cpputils/logger.hpp>
+#include <cstring>
 
-    return hash<size_t>()(other.id);
-}
-
-AssetId::AssetId(const size_t id_val) : id(id_val)
+// Names are never released : the table only grows with the distinct names used at runtime
+static TConcurrentPtrMap<const char>& get_interned_names()
 {
+    static TConcurrentPtrMap<const char> interned_names;
+    return interned_names;
 }
 
-AssetId::AssetId(const AssetId& other) : AssetId(other.id)
+std::size_t std::hash<AssetId>::operator()(const AssetId& other) const noexcept
 {
-#ifdef _DEBUG
-    asset_name = other.asset_name;
-#endif
+    return other.id;
 }
 
-AssetId::AssetId(const AssetId&& other) noexcept : AssetId(other.id)
+AssetId::AssetId(std::string_view name) : AssetId(hash(name))
 {
+    TConcurrentPtrMap<const char>& names = get_interned_names();
+    if ([[maybe_unused]] const char* interned_name = names.find(id))
+    {
 #ifdef _DEBUG
-    asset_name = other.asset_name;
-#endif
-}
-AssetId::AssetId(const std::string& name) : AssetId(std::hash<std::string>{}(name))
-{
-#ifdef _DEBUG
-    asset_name = name;
+        if (std::string_view(interned_name) != name)
+            LOG_ERROR("asset id collision : '%s' and '%.*s' have the same id %zu", interned_name, static_cast<int>(name.size()), name.data(), id);
 #endif
+        return;
+    }
+
+    char* interned_name = static_cast<char*>(memory::malloc(name.size() + 1, MemoryTag::Assets));
+    memcpy(interned_name, name.data(), name.size());
+    interned_name[name.size()] = '\0';
+    // Another thread may have interned the same name meanwhile
+    if (!names.try_insert(id, interned_name))
+        memory::free(interned_name);
 }
 
 std::string AssetId::to_string() const
 {
-#ifdef _DEBUG
-    return asset_name;
-#else
+    if (const char* interned_name = get_interned_names().find(id))
+        return interned_name;
     return std::to_string(id);
-#endif
 }
@@ -0,0 +1,178 @@
+#include "assets/asset_load_graph.h"
+
+#include "jobSystem/task_graph.h"
+
+#include <cpputils/stringutils.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+static uint64_t elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+void AssetLoadGraph::add_custom(const AssetId& asset_id, std::initializer_list<AssetId> dependencies, std::function<bool()> create_function)
+{
+    if (node_indices.contains(asset_id))
+    {
+        LOG_ERROR("asset %s is already part of the load graph", asset_id.to_string().c_str());
+        return;
+    }
+    node_indices.emplace(asset_id, nodes.size());
+    nodes.emplace_back(Node{
+        .id              = asset_id,
+        .name            = asset_id.to_string(),
+        .dependencies    = dependencies,
+        .predecessors    = {},
+        .create_function = std::move(create_function),
+    });
+}
+
+bool AssetLoadGraph::load()
+{
+    report = {};
+    for (Node& node : nodes)
+    {
+        node.predecessors.clear();
+        for (const AssetId& dependency : node.dependencies)
+        {
+            if (const auto found = node_indices.find(dependency); found != node_indices.end())
+                node.predecessors.emplace_back(found->second);
+            else if (AssetManager::get()->get_load_state(dependency) != AssetLoadState::Ready)
+            {
+                LOG_ERROR("cannot load asset graph : %s depends on %s, which is neither loaded nor part of the graph", node.name.c_str(), dependency.to_string().c_str());
+                return false;
+            }
+        }
+    }
+
+    std::vector<size_t> sorted_nodes;
+    if (!sort_nodes(sorted_nodes))
+        return false;
+
+    // Nodes are sorted : predecessor tasks are always added first
+    job_system::TaskGraph                      task_graph;
+    std::vector<job_system::TaskGraph::TaskId> task_ids(nodes.size());
+    for (const size_t index : sorted_nodes)
+    {
+        task_ids[index] = task_graph.add_task(nodes[index].name.c_str(),
+                                              [this, index]
+                                              {
+                                                  Node& node = nodes[index];
+                                                  // Assets depending on a failed asset are not created
+                                                  for (const size_t predecessor : node.predecessors)
+                                                      if (!nodes[predecessor].succeeded)
+                                                          return;
+
+                                                  const auto start = std::chrono::steady_clock::now();
+                                                  node.succeeded   = node.create_function();
+                                                  node.duration    = elapsed_ns(start);
+                                              });
+        for (const size_t predecessor : nodes[index].predecessors)
+            task_graph.add_dependency(task_ids[index], task_ids[predecessor]);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    if (const job_system::JobPtr run = task_graph.submit())
+        run->wait();
+    build_report(sorted_nodes, elapsed_ns(start));
+
+    nodes.clear();
+    node_indices.clear();
+    return report.failed_assets == 0;
+}
+
+bool AssetLoadGraph::sort_nodes(std::vector<size_t>& sorted_nodes) const
+{
+    enum class Mark : uint8_t
+    {
+        None,
+        Visiting,
+        Done,
+    };
+
+    // Depth first traversal : a node is appended once all its dependencies are. Meeting a node being visited closes a cycle
+    std::vector<Mark>                      marks(nodes.size(), Mark::None);
+    std::vector<std::pair<size_t, size_t>> stack; // Node, next predecessor to visit
+    sorted_nodes.reserve(nodes.size());
+    for (size_t root = 0; root < nodes.size(); ++root)
+    {
+        if (marks[root] != Mark::None)
+            continue;
+        marks[root] = Mark::Visiting;
+        stack.emplace_back(root, 0);
+
+        while (!stack.empty())
+        {
+            auto& [node, next_predecessor] = stack.back();
+            if (next_predecessor == nodes[node].predecessors.size())
+            {
+                marks[node] = Mark::Done;
+                sorted_nodes.emplace_back(node);
+                stack.pop_back();
+                continue;
+            }
+
+            const size_t predecessor = nodes[node].predecessors[next_predecessor++];
+            if (marks[predecessor] == Mark::Visiting)
+            {
+                std::string cycle;
+                for (auto it = std::find_if(stack.begin(), stack.end(), [predecessor](const auto& item) { return item.first == predecessor; }); it != stack.end(); ++it)
+                    cycle += nodes[it->first].name + " -> ";
+                cycle += nodes[predecessor].name;
+                LOG_ERROR("cannot load asset graph : dependency cycle %s", cycle.c_str());
+                return false;
+            }
+            if (marks[predecessor] == Mark::None)
+            {
+                marks[predecessor] = Mark::Visiting;
+                stack.emplace_back(predecessor, 0);
+            }
+        }
+    }
+    return true;
+}
+
+void AssetLoadGraph::build_report(const std::vector<size_t>& sorted_nodes, uint64_t elapsed_time)
+{
+    // Longest path in the DAG, weighted by creation times
+    std::vector<uint64_t> path_times(nodes.size(), 0);
+    std::vector<size_t>   previous_nodes(nodes.size(), SIZE_MAX);
+    size_t                last_node = SIZE_MAX;
+    for (const size_t index : sorted_nodes)
+    {
+        const Node& node = nodes[index];
+        for (const size_t predecessor : node.predecessors)
+        {
+            if (path_times[predecessor] >= path_times[index])
+            {
+                path_times[index]     = path_times[predecessor];
+                previous_nodes[index] = predecessor;
+            }
+        }
+        path_times[index] += node.duration;
+        if (last_node == SIZE_MAX || path_times[index] > path_times[last_node])
+            last_node = index;
+
+        report.total_time += node.duration;
+        if (!node.succeeded)
+            report.failed_assets++;
+    }
+    report.elapsed_time = elapsed_time;
+
+    std::string critical_path;
+    for (size_t index = last_node; index != SIZE_MAX; index = previous_nodes[index])
+    {
+        report.critical_path.emplace_back(nodes[index].id);
+        critical_path = stringutils::format("%s (%.2f ms)", nodes[index].name.c_str(), static_cast<double>(nodes[index].duration) / 1000000.0) + (critical_path.empty() ? "" : " -> ") + critical_path;
+    }
+    std::reverse(report.critical_path.begin(), report.critical_path.end());
+    if (last_node != SIZE_MAX)
+        report.critical_path_time = path_times[last_node];
+
+    LOG_INFO("[ Assets] loaded %zu assets in %.2f ms (%.2f ms of creation), critical path %.2f ms : %s", nodes.size(), static_cast<double>(report.elapsed_time) / 1000000.0,
+             static_cast<double>(report.total_time) / 1000000.0, static_cast<double>(report.critical_path_time) / 1000000.0, critical_path.c_str());
+    if (report.failed_assets != 0)
+        LOG_ERROR("%zu assets of the load graph failed to load", report.failed_assets);
+}
@@ -188,12 +188,26 @@ void AMaterialInstance::update_descriptor_sets(const std::string& render_pass, N
 
     for (auto& property : textures)
     {
-        TAssetPtr<ATexture> texture = property.base_property.texture;
-        if (!texture)
+        // Resolve the stored handle itself : once its texture is removed (ie. framebuffer images recreated on resize), it releases it and binds the new one
+        TAssetPtr<ATexture>& stored_texture = property.base_property.texture;
+        TAssetPtr<ATexture>  texture;
+        if (stored_texture.get())
         {
-            LOG_WARNING("texture used in material %s is NULL", to_string().c_str());
-            property.base_property.texture = TAssetPtr<ATexture>("default_texture");
-            texture                        = property.base_property.texture;
+            texture = stored_texture;
+        }
+        else
+        {
+            // Textures created with AssetManager::create_async() are replaced by the default texture until they are ready
+            if (stored_texture.get_load_state() == AssetLoadState::Loading)
+            {
+                texture = TAssetPtr<ATexture>("default_texture"_asset);
+            }
+            else
+            {
+                LOG_WARNING("texture used in material %s is NULL", to_string().c_str());
+                stored_texture = TAssetPtr<ATexture>("default_texture"_asset);
+                texture        = stored_texture;
+            }
         }
         VkWriteDescriptorSet descriptor = property.write_descriptor_set;
         descriptor.dstSet               = descriptor_sets;
@@ -1,13 +1,7 @@
-
 #include "assets/asset_ptr.h"
 
 #include "assets/asset_base.h"
 
-IAssetPtr::IAssetPtr()
-{
-    clear();
-}
-
 IAssetPtr::IAssetPtr(const AssetId& in_asset_id)
 {
     set(in_asset_id);
@@ -18,107 +12,167 @@ IAssetPtr::IAssetPtr(AssetBase* in_asset)
     set(in_asset);
 }
 
-IAssetPtr::IAssetPtr(const IAssetPtr& other) : asset_id(other.asset_id), asset(other.asset)
+IAssetPtr::IAssetPtr(const IAssetPtr& other)
 {
-    set(other.asset);
+    *this = other;
 }
 
 IAssetPtr::IAssetPtr(IAssetPtr&& other) noexcept
 {
-    set(other.asset);
+    *this = std::move(other);
+}
+
+IAssetPtr::~IAssetPtr()
+{
+    release();
 }
 
 void IAssetPtr::set(AssetBase* in_asset)
 {
-    if (in_asset == asset)
-        return;
-    clear();
+    // Released last : in_asset may only be kept alive by the current reference
+    IAssetPtr previous(std::move(*this));
     if (!in_asset)
         return;
-    asset_id = std::make_shared<AssetId>(in_asset->get_id());
-    asset    = in_asset;
-    bind();
+    asset_id = in_asset->get_id();
+    acquire(in_asset);
 }
 
 void IAssetPtr::set(const AssetId& in_asset_id)
 {
-    if (asset_id && in_asset_id == *asset_id)
+    if (in_asset_id == asset_id)
         return;
     clear();
-    asset_id = std::make_shared<AssetId>(in_asset_id);
-    if (AssetManager::is_valid())
-        asset = AssetManager::get()->find(*asset_id);
-    bind();
+    // Resolved by the first get() : handles stored by id and only read through const accessors (ie. shader configurations) never keep a texture alive
+    asset_id = in_asset_id;
 }
 
-void IAssetPtr::operator=(const IAssetPtr& other)
+void IAssetPtr::clear()
 {
-    set(other.asset);
+    release();
+    asset_id = NULL_ID;
 }
 
-void IAssetPtr::clear()
+IAssetPtr& IAssetPtr::operator=(const IAssetPtr& other)
 {
-    unbind();
+    if (this == &other)
+        return *this;
+    clear();
+    asset_id = other.asset_id;
+    // Stale handles are copied unresolved : the copy doesn't keep a removed asset alive
+    if (other.slot_index != INVALID_SLOT && AssetManager::is_valid())
+    {
+        AssetManager* manager = AssetManager::get();
+        if (manager->get_slot(other.slot_index).generation.load(std::memory_order_acquire) == other.generation && manager->try_add_reference(other.slot_index))
+        {
+            slot_index = other.slot_index;
+            generation = other.generation;
+        }
+    }
+    return *this;
+}
 
-    asset    = nullptr;
-    asset_id = nullptr;
+IAssetPtr& IAssetPtr::operator=(IAssetPtr&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+    release();
+    asset_id         = other.asset_id;
+    slot_index       = other.slot_index;
+    generation       = other.generation;
+    other.asset_id   = NULL_ID;
+    other.slot_index = INVALID_SLOT;
+    return *this;
 }
 
 AssetBase* IAssetPtr::get()
 {
-    if (!asset_id)
+    if (slot_index != INVALID_SLOT && AssetManager::is_valid())
+    {
+        const AssetManager::AssetSlot& slot = AssetManager::get()->get_slot(slot_index);
+        if (slot.generation.load(std::memory_order_acquire) == generation)
+            return slot.load_state.load(std::memory_order_acquire) == AssetLoadState::Ready ? slot.asset.load(std::memory_order_relaxed) : nullptr;
+        release();
+    }
+    if (asset_id() == NULL_ID || !AssetManager::is_valid())
         return nullptr;
-    if (!asset)
-        if (AssetManager::is_valid())
-            asset = AssetManager::get()->find(*asset_id);
-    if (asset)
+
+    // Reference the slot before touching the asset : it can be removed and deleted meanwhile. Retry if the id was recreated in another slot
+    AssetManager* manager = AssetManager::get();
+    while (const AssetManager::AssetSlot* slot = manager->assets.find(asset_id()))
     {
-        return asset;
+        if (manager->try_acquire(*slot, asset_id, generation))
+        {
+            slot_index = slot->index;
+            return slot->load_state.load(std::memory_order_acquire) == AssetLoadState::Ready ? slot->asset.load(std::memory_order_relaxed) : nullptr;
+        }
+        if (manager->assets.find(asset_id()) == slot)
+            return nullptr;
     }
     return nullptr;
 }
 
 AssetBase* IAssetPtr::get_const() const
 {
-    if (!asset_id)
-        return nullptr;
-    if (asset)
-    {
+    if (AssetBase* asset = get_referenced())
         return asset;
-    }
-    return nullptr;
+    if (asset_id() == NULL_ID || !AssetManager::is_valid())
+        return nullptr;
+    return AssetManager::get()->find(asset_id);
 }
 
-std::string IAssetPtr::to_string() const
+AssetBase* IAssetPtr::get_referenced() const
 {
-    if (!asset)
-        return "null";
-    return asset->to_string();
+    if (slot_index == INVALID_SLOT || !AssetManager::is_valid())
+        return nullptr;
+    const AssetManager::AssetSlot& slot = AssetManager::get()->get_slot(slot_index);
+    if (slot.generation.load(std::memory_order_acquire) != generation || slot.load_state.load(std::memory_order_acquire) != AssetLoadState::Ready)
+        return nullptr;
+    return slot.asset.load(std::memory_order_relaxed);
 }
 
-IAssetPtr::~IAssetPtr()
+AssetLoadState IAssetPtr::get_load_state() const
 {
-    clear();
+    if (asset_id() == NULL_ID || !AssetManager::is_valid())
+        return AssetLoadState::Missing;
+    if (slot_index != INVALID_SLOT)
+    {
+        const AssetManager::AssetSlot& slot = AssetManager::get()->get_slot(slot_index);
+        if (slot.generation.load(std::memory_order_acquire) == generation)
+            return slot.load_state.load(std::memory_order_acquire);
+        // The referenced slot can't be reused : it still reports a failed load, unless the asset was recreated meanwhile
+        const AssetLoadState state = AssetManager::get()->get_load_state(asset_id);
+        if (state == AssetLoadState::Missing && slot.load_state.load(std::memory_order_acquire) == AssetLoadState::Failed)
+            return AssetLoadState::Failed;
+        return state;
+    }
+    return AssetManager::get()->get_load_state(asset_id);
 }
 
-void IAssetPtr::unbind()
+std::string IAssetPtr::to_string() const
 {
-    if (asset)
-    {
-        asset->on_delete_asset.clear_object(this);
-    }
+    const AssetBase* asset = get_const();
+    if (!asset)
+        return "null";
+    return asset->to_string();
 }
 
-void IAssetPtr::bind()
+bool IAssetPtr::acquire(AssetBase* in_asset)
 {
-    if (asset)
-    {
-        asset->on_delete_asset.add_object(this, &IAssetPtr::on_delete_asset);
-    }
+    // The caller keeps in_asset alive : only its removal is checked
+    AssetManager*                  manager = AssetManager::get();
+    const AssetManager::AssetSlot& slot    = manager->get_slot(in_asset->slot_index);
+    if (!manager->try_acquire(slot, asset_id, generation))
+        return false;
+    slot_index = in_asset->slot_index;
+    return true;
 }
 
-void IAssetPtr::on_delete_asset(AssetBase* deleted_asset)
+void IAssetPtr::release()
 {
-    if (deleted_asset == asset)
-        set(nullptr);
+    if (slot_index == INVALID_SLOT)
+        return;
+    // The manager deletes every remaining asset when it is destroyed
+    if (AssetManager::is_valid())
+        AssetManager::get()->release_reference(slot_index);
+    slot_index = INVALID_SLOT;
 }
@@ -4,11 +4,14 @@
 
 #include "assets/asset_base.h"
 #include "game_engine.h"
+#include "jobSystem/job_system.h"
 #include "rendering/graphics.h"
 #include "rendering/renderer/renderer.h"
 #include "rendering/swapchain_config.h"
 #include "rendering/vulkan/common.h"
+#include "config.h"
 #include "statsRecorder.h"
+#include "telemetry.h"
 
 static std::shared_ptr<IEngineInterface> engine_interface_reference;
 
@@ -67,8 +70,18 @@ void IEngineInterface::run_main_task(const WindowParameters& window_parameters)
     // Load resource
     engine_load_resources();
 
+    // Aggregate recorded scopes per frame
+    FrameProfiler::get().set_enabled(true);
+
+    // Keep per-scope histograms for the whole session : SIGUSR1 dumps them to the profiler storage
+    telemetry::set_enabled(true);
+    telemetry::install_dump_signal();
+
     do
     {
+        // recycle job memory of previous frames
+        job_system::begin_frame();
+
         // poll inputs
         input_manager->poll_events(get_delta_second());
 
@@ -78,12 +91,16 @@ void IEngineInterface::run_main_task(const WindowParameters& window_parameters)
         last_delta_second_time = now;
 
         engine_tick(delta_second);
+        AssetManager::get()->dispatch_load_callbacks();
         AssetManager::get()->try_delete_dirty_items();
 
         // render scene
         auto swapchain_frame = Graphics::get()->begin_frame();
         Graphics::get()->get_renderer()->render_frame(swapchain_frame);
         Graphics::get()->end_frame(swapchain_frame);
+
+        FrameProfiler::get().end_frame();
+        telemetry::poll_dump_request(config::profiler_storage_path);
     } while (!glfwWindowShouldClose(Graphics::get()->get_glfw_handle()));
 
     vkDeviceWaitIdle(Graphics::get()->get_logical_device());
@@ -138,7 +138,7 @@ void DebugDraw::render_wireframe(SwapchainFrame& in_render_context)
         memcpy(vtx_dst, vertices.data(), new_data_size);
         vkUnmapMemory(Graphics::get()->get_logical_device(), buffer_memories[in_render_context.image_index]);
         
-        TAssetPtr<AMaterialInstance>("debug_draw_material_instance")->bind_material(in_render_context);
+        TAssetPtr<AMaterialInstance>("debug_draw_material_instance"_asset)->bind_material(in_render_context);
 
         // draw vertices
         VkDeviceSize offsets[] = {0};
@@ -57,6 +57,10 @@ void GfxInterface::init(const WindowParameters& window_parameters)
     if (queue_families.present_family.has_value())
         vkGetDeviceQueue(logical_device, queue_families.present_family.value(), 0, &present_queue);
 
+    LOG_INFO("[ GFX] : create command pools");
+    // Before anything records commands : assets can be created from any worker
+    command_pool::create_pools(logical_device, queue_families.graphic_family.value());
+
     LOG_INFO("[ GFX] : create vulkan memory allocator");
     // Create VMA allocator
     VmaAllocatorCreateInfo allocatorInfo = {
@@ -1,6 +1,5 @@
 #include "rendering/vulkan/command_pool.h"
 #include "jobSystem/worker.h"
-#include "rendering/graphics.h"
 
 #include <cpputils/logger.hpp>
 
@@ -25,23 +24,23 @@ VkCommandPool& CommandPool::get()
     return commandPool;
 }
 
-CommandPool::operator bool()
+bool CommandPool::is_owned() const
 {
-    if (!is_created)
-    {
-        is_created     = true;
-        pool_thread_id = std::this_thread::get_id();
-        return true;
-    }
-    return std::this_thread::get_id() == pool_thread_id;
+    return pool_thread_id.load(std::memory_order_relaxed) == std::this_thread::get_id();
 }
 
-Container::Container() : context_logical_device(Graphics::get()->get_logical_device()), context_queue(Graphics::get()->get_queue_family_indices().graphic_family.value())
+bool CommandPool::try_claim()
+{
+    std::thread::id free_pool;
+    return pool_thread_id.compare_exchange_strong(free_pool, std::this_thread::get_id(), std::memory_order_relaxed);
+}
+
+Container::Container(VkDevice logical_device, uint32_t queue) : context_logical_device(logical_device), context_queue(queue)
 {
     command_pool_count = job_system::Worker::get_worker_count() + 1; // One for each worker, plus one for the main thread
-    LOG_INFO("[ Core] Create command pool for %d workers", command_pool_count);
+    LOG_INFO("[ Core] Create command pool for %zu workers", command_pool_count);
     command_pools = static_cast<CommandPool*>(std::malloc(command_pool_count * sizeof(CommandPool)));
-    for (int i = 0; i < static_cast<int>(command_pool_count); ++i)
+    for (size_t i = 0; i < command_pool_count; ++i)
     {
         new (command_pools + i) CommandPool(context_logical_device, context_queue);
     }
@@ -50,33 +49,41 @@ Container::Container() : context_logical_device(Graphics::get()->get_logical_dev
 Container::~Container()
 {
     LOG_INFO("[ Core] Destroy command pools");
-    for (int i = 0; i < command_pool_count; ++i)
+    for (size_t i = 0; i < command_pool_count; ++i)
     {
         command_pools[i].destroy();
+        command_pools[i].~CommandPool();
     }
     free(command_pools);
 }
 
 VkCommandPool& Container::get()
 {
-    for (int i = 0; i < command_pool_count; ++i)
-    {
-        if (CommandPool& pool = command_pools[i])
-        {
-            return pool.get();
-        }
-    }
+    // Look for the pool of this thread first : a thread must never claim a second pool
+    for (size_t i = 0; i < command_pool_count; ++i)
+        if (command_pools[i].is_owned())
+            return command_pools[i].get();
+
+    for (size_t i = 0; i < command_pool_count; ++i)
+        if (command_pools[i].try_claim())
+            return command_pools[i].get();
+
     LOG_FATAL("no command pool is available on current thread");
 }
 
 std::unique_ptr<Container> container = nullptr;
 
+void create_pools(VkDevice logical_device, uint32_t queue)
+{
+    if (container)
+        LOG_FATAL("command pools are already created");
+    container = std::make_unique<Container>(logical_device, queue);
+}
+
 VkCommandPool& get()
 {
     if (!container)
-    {
-        container = std::make_unique<Container>();
-    }
+        LOG_FATAL("command pools are not created yet");
     return container->get();
 }
 
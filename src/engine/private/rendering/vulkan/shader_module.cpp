@@ -119,7 +119,11 @@ static TBuiltInResource glslang_default_resource = {
 void ShaderModule::set_bytecode(const std::vector<uint32_t>& in_bytecode)
 {
     access_lock.lock();
+    if (!bytecode.empty())
+        memory::track_free(MemoryTag::ShaderModule, bytecode.size() * sizeof(uint32_t));
     bytecode = in_bytecode;
+    if (!bytecode.empty())
+        memory::track_allocation(MemoryTag::ShaderModule, bytecode.size() * sizeof(uint32_t));
     mark_dirty();
     access_lock.unlock();
 }
@@ -147,6 +151,8 @@ static ShaderModule::ShaderCompilationError get_compilation_error(glslang_shader
 
 void ShaderModule::set_plain_text(const std::string& in_shader_text)
 {
+    // Compiler allocations are attributed to shader modules when global allocations are tracked
+    memory::TagScope memory_tag(MemoryTag::ShaderModule);
     glslang_stage_t glslang_shader_stage = GLSLANG_STAGE_COUNT;
     switch (shader_stage)
     {
@@ -268,6 +274,8 @@ const std::vector<uint32_t>& ShaderModule::get_bytecode()
 ShaderModule::~ShaderModule()
 {
     access_lock.lock();
+    if (!bytecode.empty())
+        memory::track_free(MemoryTag::ShaderModule, bytecode.size() * sizeof(uint32_t));
     destroy();
     access_lock.unlock();
 }
@@ -196,6 +196,11 @@ void end_single_time_commands(VkCommandBuffer commandBuffer)
     vkFreeCommandBuffers(Graphics::get()->get_logical_device(), command_pool::get(), 1, &commandBuffer);
 }
 
+job_system::Task<void> wait_fence_async(VkFence fence)
+{
+    co_await job_system::blocking_call([fence] { vkWaitForFences(Graphics::get()->get_logical_device(), 1, &fence, VK_TRUE, UINT64_MAX); });
+}
+
 void create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
 {
     VkBufferCreateInfo bufferInfo{};
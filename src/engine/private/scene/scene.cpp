@@ -4,6 +4,8 @@
 
 #include "scene/node_primitive.h"
 
+#include "jobSystem/parallel_for.h"
+
 struct ModMatrix
 {
     glm::mat4 a;
@@ -15,6 +17,5 @@ Scene::Scene()
 void Scene::tick(const double delta_second)
 {
     BEGIN_NAMED_RECORD(TICK_WORLD);
-    for (const auto& component : scene_nodes)
-        component->tick(delta_second);
+    job_system::parallel_for<size_t>(0, scene_nodes.size(), 64, [this, delta_second](size_t i) { scene_nodes[i]->tick(delta_second); });
 }
\ No newline at end of file
@@ -396,7 +396,7 @@ void ImGuiImplementation::ImGui_ImplVulkan_RenderDrawData(ImDrawData* draw_data,
                     VkDescriptorSet desc_set[1] = {static_cast<VkDescriptorSet>(pcmd->TextureId)};
                     if (!pcmd->TextureId)
                         desc_set[1] = {static_cast<VkDescriptorSet>(
-                            TAssetPtr<ATexture>("default_texture")->get_imgui_handle(0, *TAssetPtr<AMaterialBase>("imgui_base_material")->get_pipeline("ui_render_pass")->get_descriptor_sets_layouts()))};
+                            TAssetPtr<ATexture>("default_texture"_asset)->get_imgui_handle(0, *TAssetPtr<AMaterialBase>("imgui_base_material"_asset)->get_pipeline("ui_render_pass")->get_descriptor_sets_layouts()))};
                     vkCmdBindDescriptorSets(render_context.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *pipeline->get_pipeline_layout(), 0, 1, desc_set, 0, NULL);
 
                     // Draw
@@ -2,7 +2,11 @@
 #include "ui/window/windows/profiler.h"
 
 #include "jobSystem/job.h"
+#include "jobSystem/job_trace.h"
 #include "jobSystem/worker.h"
+#include "memory_tracker.h"
+#include "telemetry.h"
+#include "types/fast_mutex.h"
 
 #include "imgui.h"
 #include <cpputils/logger.hpp>
@@ -14,9 +18,40 @@ double ProfilerWindow::time_to_local(const record_clock::time_point& time)
 
 void ProfilerWindow::draw_content()
 {
-    draw_thread_stats();
-    ImGui::Separator();
-    draw_profiler_history();
+    if (ImGui::BeginTabBar("profiler_tabs"))
+    {
+        if (ImGui::BeginTabItem("jobs"))
+        {
+            draw_thread_stats();
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("frame"))
+        {
+            draw_frame_scopes();
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("memory"))
+        {
+            draw_memory_stats();
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("locks"))
+        {
+            draw_lock_stats();
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("telemetry"))
+        {
+            draw_telemetry();
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("record"))
+        {
+            draw_profiler_history();
+            ImGui::EndTabItem();
+        }
+        ImGui::EndTabBar();
+    }
 }
 
 void ProfilerWindow::draw_thread_stats()
@@ -55,6 +90,23 @@ void ProfilerWindow::draw_thread_stats()
     ImGui::SameLine();
     ImGui::Text("awaiting jobs : %ld", job_system::IJobTask::get_stat_total_job_count(), job_system::IJobTask::get_stat_awaiting_job_count());
 
+    const job_system::Worker::ParkingStats parking_stats = job_system::Worker::get_parking_stats();
+    ImGui::Text("idle spins : %lu | parks : %lu | wake ups : %lu", parking_stats.spins, parking_stats.parks, parking_stats.wake_ups);
+
+    if (job_system::trace::is_enabled())
+    {
+        if (ImGui::Button("stop job trace"))
+        {
+            job_system::trace::stop();
+            job_system::trace::export_chrome_trace("job_trace.json");
+        }
+    }
+    else if (ImGui::Button("start job trace"))
+    {
+        job_system::trace::clear();
+        job_system::trace::start();
+    }
+
     ImGui::Separator();
     for (int i = 0; i < job_system::Worker::get_worker_count(); ++i)
     {
@@ -63,6 +115,155 @@ void ProfilerWindow::draw_thread_stats()
     }
 }
 
+void ProfilerWindow::draw_frame_scopes()
+{
+    const auto to_ms = [](FrameProfiler::Duration duration) { return static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()) / 1000.f; };
+
+    const FrameProfiler::Percentiles frame_time = FrameProfiler::get().get_frame_time();
+    ImGui::Text("frame time over %zu frames : p50 %.2fms | p95 %.2fms | p99 %.2fms | max %.2fms", FrameProfiler::get().get_frame_count(), to_ms(frame_time.p50), to_ms(frame_time.p95), to_ms(frame_time.p99),
+                to_ms(frame_time.max));
+
+    ImGui::Columns(6, "frame_scopes");
+    ImGui::Text("scope");
+    ImGui::NextColumn();
+    ImGui::Text("calls");
+    ImGui::NextColumn();
+    ImGui::Text("exclusive p50");
+    ImGui::NextColumn();
+    ImGui::Text("inclusive p50");
+    ImGui::NextColumn();
+    ImGui::Text("inclusive p95");
+    ImGui::NextColumn();
+    ImGui::Text("inclusive p99");
+    ImGui::NextColumn();
+    ImGui::Separator();
+    for (const FrameProfiler::ScopeReport& scope : FrameProfiler::get().get_report())
+    {
+        ImGui::Text("%*s%s", static_cast<int>(scope.depth) * 2, "", profiler_scope::get_display_name(profiler_scope::get(scope.scope)));
+        ImGui::NextColumn();
+        ImGui::Text("%u", scope.last_calls);
+        ImGui::NextColumn();
+        ImGui::Text("%.3fms", to_ms(scope.exclusive.p50));
+        ImGui::NextColumn();
+        ImGui::Text("%.3fms", to_ms(scope.inclusive.p50));
+        ImGui::NextColumn();
+        ImGui::Text("%.3fms", to_ms(scope.inclusive.p95));
+        ImGui::NextColumn();
+        ImGui::Text("%.3fms", to_ms(scope.inclusive.p99));
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+}
+
+void ProfilerWindow::draw_memory_stats()
+{
+    const auto to_mb = [](int64_t bytes) { return static_cast<float>(bytes) / (1024.f * 1024.f); };
+
+    if (!memory::is_global_hook_enabled())
+        ImGui::TextDisabled("global allocations are not tracked (HE_TRACK_GLOBAL_ALLOCATIONS)");
+
+    ImGui::Columns(5, "memory_stats");
+    ImGui::Text("subsystem");
+    ImGui::NextColumn();
+    ImGui::Text("live");
+    ImGui::NextColumn();
+    ImGui::Text("peak");
+    ImGui::NextColumn();
+    ImGui::Text("live allocations");
+    ImGui::NextColumn();
+    ImGui::Text("total allocations");
+    ImGui::NextColumn();
+    ImGui::Separator();
+    for (size_t i = 0; i < static_cast<size_t>(MemoryTag::Count); ++i)
+    {
+        const MemoryTag        tag   = static_cast<MemoryTag>(i);
+        const memory::TagStats stats = memory::get_stats(tag);
+        ImGui::Text("%s", memory::get_tag_name(tag));
+        ImGui::NextColumn();
+        ImGui::Text("%.2f MB", to_mb(stats.live_bytes));
+        ImGui::NextColumn();
+        ImGui::Text("%.2f MB", to_mb(stats.peak_bytes));
+        ImGui::NextColumn();
+        ImGui::Text("%ld", stats.live_allocations);
+        ImGui::NextColumn();
+        ImGui::Text("%ld", stats.total_allocations);
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+}
+
+void ProfilerWindow::draw_lock_stats()
+{
+    ImGui::Columns(4, "lock_stats");
+    ImGui::Text("lock");
+    ImGui::NextColumn();
+    ImGui::Text("contentions");
+    ImGui::NextColumn();
+    ImGui::Text("parks");
+    ImGui::NextColumn();
+    ImGui::Text("wait time");
+    ImGui::NextColumn();
+    ImGui::Separator();
+    FastMutex::for_each_named_lock(
+        [](const FastMutex& mutex)
+        {
+            const FastMutex::Stats stats = mutex.get_stats();
+            ImGui::Text("%s", mutex.get_name());
+            ImGui::NextColumn();
+            ImGui::Text("%lu", stats.contentions);
+            ImGui::NextColumn();
+            ImGui::Text("%lu", stats.parks);
+            ImGui::NextColumn();
+            ImGui::Text("%.3fms", static_cast<float>(stats.wait_time.count()) / 1000000.f);
+            ImGui::NextColumn();
+        });
+    ImGui::Columns(1);
+}
+
+void ProfilerWindow::draw_telemetry()
+{
+    const auto to_ms = [](uint64_t ns) { return static_cast<float>(ns) / 1000000.f; };
+
+    if (!telemetry::is_enabled())
+        ImGui::TextDisabled("telemetry is disabled");
+    if (ImGui::Button("dump"))
+        telemetry::request_dump();
+    ImGui::SameLine();
+    if (ImGui::Button("reset"))
+        telemetry::reset();
+
+    ImGui::Columns(6, "telemetry");
+    ImGui::Text("scope");
+    ImGui::NextColumn();
+    ImGui::Text("calls");
+    ImGui::NextColumn();
+    ImGui::Text("p50");
+    ImGui::NextColumn();
+    ImGui::Text("p99");
+    ImGui::NextColumn();
+    ImGui::Text("p99.9");
+    ImGui::NextColumn();
+    ImGui::Text("max");
+    ImGui::NextColumn();
+    ImGui::Separator();
+    for (const telemetry::ScopeStats& stats : telemetry::get_stats())
+    {
+        ImGui::Text("%s", profiler_scope::get_display_name(profiler_scope::get(stats.scope)));
+        ImGui::NextColumn();
+        ImGui::Text("%lu", stats.calls);
+        ImGui::NextColumn();
+        ImGui::Text("%.3fms", to_ms(stats.p50_ns));
+        ImGui::NextColumn();
+        ImGui::Text("%.3fms", to_ms(stats.p99_ns));
+        ImGui::NextColumn();
+        ImGui::Text("%.3fms", to_ms(stats.p999_ns));
+        ImGui::NextColumn();
+        ImGui::Text("%.3fms", to_ms(stats.max_ns));
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+}
+
 void ProfilerWindow::draw_profiler_history()
 {
 
@@ -127,16 +328,18 @@ void ProfilerWindow::draw_profiler_history()
                         if (max.x < min.x + 2)
                             max.x = min.x + 2;
 
+                        const ProfilerScope& scope = profiler_scope::get(elem.scope);
                         if (ImGui::IsMouseHoveringRect(min, max))
                         {
                             ImGui::BeginTooltip();
-                            ImGui::Text("%s => %s\nduration : %fms\n", elem.name, elem.function_name, std::chrono::duration_cast<std::chrono::microseconds>(elem.duration).count() / 1000.f);
+                            ImGui::Text("%s => %s\n%s:%u\nduration : %fms\n", scope.name, scope.function_name, scope.file, scope.line,
+                                        std::chrono::duration_cast<std::chrono::microseconds>(elem.duration).count() / 1000.f);
                             ImGui::EndTooltip();
                             ImGui::GetWindowDrawList()->AddRectFilled(min, max, IM_COL32(255, 255, 0, 100));
                         }
                         else
                         {
-                            ImGui::GetWindowDrawList()->AddRectFilled(min, max, IM_COL32(255, 0, 0, 100));
+                            ImGui::GetWindowDrawList()->AddRectFilled(min, max, scope.color);
                         }
                     }
                 }
@@ -1,10 +1,18 @@
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "asset_id.h"
 #include "asset_ptr.h"
+#include "jobSystem/job_system.h"
+#include "memory_tracker.h"
+#include "types/concurrent_ptr_map.h"
+#include "types/fast_mutex.h"
 #include "types/nonCopiable.h"
 
 #include <cpputils/logger.hpp>
@@ -30,7 +38,7 @@ class AssetManager
 
     template <typename AssetManager_T = AssetManager> static AssetManager_T* get()
     {
-        return static_cast<AssetManager_T*>(get_internal().get());
+        return static_cast<AssetManager_T*>(get_internal());
     }
 
     [[nodiscard]] static bool is_valid();
@@ -41,53 +49,163 @@ class AssetManager
 
     template <class AssetClass, typename... Args> TAssetPtr<AssetClass> create(const AssetId& asset_id, Args... args)
     {
-        if (exists(asset_id))
-        {
-            LOG_ERROR("Cannot create two asset with the same id : %s", asset_id.to_string().c_str());
+        AssetClass* asset_ptr = allocate_asset<AssetClass>(asset_id);
+        if (!asset_ptr)
             return nullptr;
-        }
 
-        AssetClass* asset_ptr = static_cast<AssetClass*>(std::malloc(sizeof(AssetClass)));
+        ::new (asset_ptr) AssetClass(std::forward<Args>(args)...);
+        finish_loading(asset_ptr, true);
+        return asset_ptr;
+    }
+
+    /**
+     * Return at once a handle to an asset in the Loading state, constructed by a background job.
+     * The asset becomes Ready, or Failed if try_load() returns false once constructed. Handles resolve to nullptr until it is Ready.
+     */
+    template <class AssetClass, typename... Args> TAssetPtr<AssetClass> create_async(const AssetId& asset_id, Args... args)
+    {
+        AssetClass* asset_ptr = allocate_asset<AssetClass>(asset_id, AssetLoadState::Loading);
         if (!asset_ptr)
-            LOG_FATAL("failed to create asset storage");
-        asset_ptr->internal_constructor(asset_id);
+            return nullptr;
 
-        new (asset_ptr) AssetClass(std::forward<Args>(args)...);
-        asset_map_lock.lock();
-        assets[asset_id] = asset_ptr;
-        asset_map_lock.unlock();
-        return asset_ptr;
+        TAssetPtr<AssetClass> asset_handle(asset_ptr);
+        {
+            std::lock_guard lock(pending_loads_lock);
+            pending_loads++;
+        }
+        job_system::new_job(
+            [this, asset_ptr, ... arguments = std::move(args)]() mutable
+            {
+                ::new (asset_ptr) AssetClass(std::move(arguments)...);
+                finish_async_loading(asset_ptr, asset_ptr->try_load());
+            },
+            job_system::JobPriority::Background, true);
+        return asset_handle;
+    }
+
+    /**
+     * Call callback once the asset is Ready (with the asset) or Failed (with nullptr).
+     * Callbacks run on the thread calling dispatch_load_callbacks(), even if the asset is already loaded.
+     */
+    template <class AssetClass> void when_loaded(const TAssetPtr<AssetClass>& asset, std::function<void(AssetClass*)> callback)
+    {
+        add_load_callback(asset.id(), [callback = std::move(callback)](AssetBase* loaded_asset) { callback(static_cast<AssetClass*>(loaded_asset)); });
     }
 
+    /** Run the completion callbacks of the assets loaded since the last call. Called once per frame by the engine */
+    void dispatch_load_callbacks();
+
+    /** Unregister the asset. It is deleted once no handle references it anymore */
     void remove(IAssetPtr* asset_reference);
 
-    bool exists(const AssetId& id)
+    /** True as soon as the asset is being created. Lock free */
+    [[nodiscard]] bool exists(const AssetId& id) const
     {
-        return assets.find(id) != assets.end();
+        return assets.contains(id());
     }
 
-    [[nodiscard]] AssetBase*                              find(const AssetId& id);
+    /** nullptr while the asset is being created or loaded. Lock free. A removed asset can be deleted at any time : keep a handle to use it */
+    [[nodiscard]] AssetBase*                              find(const AssetId& id) const;
+    [[nodiscard]] AssetLoadState                          get_load_state(const AssetId& id) const;
     [[nodiscard]] AssetId                                 find_valid_asset_id(const std::string& asset_name);
     [[nodiscard]] std::unordered_map<AssetId, AssetBase*> get_assets();
 
+    /** Delete unreferenced assets that are ready to be deleted (see AssetBase::try_delete()) */
     void try_delete_dirty_items();
 
     EventOnDeleteAsset on_delete_asset;
 
   private:
-    static void                          set(std::shared_ptr<AssetManager> in_asset_manager);
-    static std::shared_ptr<AssetManager> get_internal();
+    friend class IAssetPtr;
+
+    // Entry of the asset table IAssetPtr handles point to. The generation is incremented when the asset is removed : handles to it become stale
+    struct AssetSlot
+    {
+        uint32_t                    index      = 0;
+        std::atomic_uint64_t        asset_id   = 0;
+        std::atomic<AssetBase*>     asset      = nullptr;
+        std::atomic_uint32_t        generation = 0;
+        std::atomic_uint32_t        references = 0;
+        std::atomic<AssetLoadState> load_state = AssetLoadState::Missing;
+    };
+
+    // Hold a reference on the asset until the callback is called. asset is nullptr for missing assets
+    struct LoadCallback
+    {
+        AssetBase*                       asset;
+        std::function<void(AssetBase*)> function;
+    };
+
+    // Slots are allocated in chunks that never move : handles read them without locking
+    static constexpr uint32_t SLOT_CHUNK_SIZE = 1024;
+    static constexpr uint32_t MAX_SLOT_CHUNKS = 1024;
 
-    std::mutex                              asset_map_lock;
-    std::mutex                              dirty_assets_lock;
-    std::unordered_map<AssetId, AssetBase*> assets;
-    std::list<AssetBase*>                   assets_to_delete;
+    static void          set(std::shared_ptr<AssetManager> in_asset_manager);
+    static AssetManager* get_internal();
+
+    // Reserve the id and the storage of a new asset. Returns nullptr if the id is already used
+    template <class AssetClass> AssetClass* allocate_asset(const AssetId& asset_id, AssetLoadState load_state = AssetLoadState::Ready)
+    {
+        // Reserve the id first : a concurrent create of the same id fails instead of constructing a duplicate
+        if (!assets.try_insert(asset_id(), nullptr))
+        {
+            LOG_ERROR("Cannot create two asset with the same id : %s", asset_id.to_string().c_str());
+            return nullptr;
+        }
+
+        AssetClass* asset_ptr = static_cast<AssetClass*>(memory::malloc(sizeof(AssetClass), MemoryTag::Assets));
+        if (!asset_ptr)
+            LOG_FATAL("failed to create asset storage");
+        // The registry holds the first reference of the slot
+        asset_ptr->internal_constructor(asset_id, allocate_slot(asset_ptr, asset_id, load_state));
+        return asset_ptr;
+    }
+
+    // Publish a constructed asset, or unregister it if it failed to load, then queue its completion callbacks
+    void finish_loading(AssetBase* asset, bool succeeded);
+    // finish_loading() for create_async() : the manager can be destroyed as soon as it returns
+    void finish_async_loading(AssetBase* asset, bool succeeded);
+    void add_load_callback(const AssetId& id, std::function<void(AssetBase*)> callback);
+
+    AssetSlot& get_slot(uint32_t index) const
+    {
+        return slot_chunks[index / SLOT_CHUNK_SIZE].load(std::memory_order_acquire)[index % SLOT_CHUNK_SIZE];
+    }
+    uint32_t allocate_slot(AssetBase* asset, const AssetId& id, AssetLoadState load_state);
+    void     free_slot(uint32_t index);
+    // Fails once the last reference has been released : the asset is waiting for deletion
+    bool try_add_reference(uint32_t index) const;
+    void release_reference(uint32_t index);
+    // Take a reference on the asset id of the slot, read from the registry. Fails if the asset was removed or failed to load, or if the slot was recycled
+    bool try_acquire(const AssetSlot& slot, const AssetId& id, uint32_t& out_generation);
+
+    // Assets are looked up by id every frame from any thread : reads don't lock. Slots never move : the registry can't return freed memory
+    TConcurrentPtrMap<AssetSlot> assets;
+
+    std::atomic<AssetSlot*> slot_chunks[MAX_SLOT_CHUNKS] = {};
+    FastMutex               slot_lock;
+    std::vector<uint32_t>   free_slots;
+    uint32_t                slot_count = 0;
+
+    std::mutex            dirty_assets_lock;
+    std::vector<uint32_t> unreferenced_slots;
+
+    // Callbacks waiting for an asset to load, and callbacks to call at the next dispatch
+    FastMutex                                                                  load_lock;
+    std::unordered_map<AssetId, std::vector<std::function<void(AssetBase*)>>> waiting_load_callbacks;
+    std::vector<LoadCallback>                                                  completed_load_callbacks;
+
+    // Asynchronous loads still running. The destructor waits for them
+    std::mutex              pending_loads_lock;
+    std::condition_variable pending_loads_condition;
+    int32_t                 pending_loads = 0;
 };
 
 class AssetBase : public NonCopiable
 {
   public:
     friend class AssetManager;
+    friend class IAssetPtr;
 
     virtual std::string to_string() const;
 
@@ -103,13 +221,25 @@ class AssetBase : public NonCopiable
 
     virtual ~AssetBase();
 
+    // Assets are allocated by AssetManager::create() : deleting them releases tracked memory
+    static void* operator new(size_t size)
+    {
+        return memory::malloc(size, MemoryTag::Assets);
+    }
+
+    static void operator delete(void* ptr)
+    {
+        memory::free(ptr);
+    }
+
     EventOnDeleteAsset on_delete_asset;
 
   protected:
     AssetBase() = default;
 
   private:
-    void internal_constructor(const AssetId& id);
+    void internal_constructor(const AssetId& id, uint32_t in_slot_index);
 
     AssetId* asset_id;
+    uint32_t slot_index;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 class AssetId;
 
@@ -10,34 +12,52 @@ template <> struct hash<AssetId>
     std::size_t operator()(const AssetId& other) const noexcept;
 };
 } // namespace std
+
+/**
+ * Asset identifier : the 64 bit FNV-1a hash of the asset name.
+ * Literals ("default_texture"_asset) are hashed at compile time. Ids built from a runtime string also intern the name in a global table,
+ * where to_string() finds it back : ids themselves don't carry their name.
+ */
 class AssetId final
 {
   public:
-    AssetId(const size_t id_val);
-    AssetId(const AssetId& other);
-    AssetId(const AssetId&& other) noexcept;
-    AssetId(const std::string& name);
-    AssetId(const char* name) : AssetId(std::string(name))
+    constexpr AssetId(const size_t id_val) : id(id_val)
     {
     }
-
-    size_t operator()() const
+    constexpr AssetId(const AssetId& other) = default;
+    AssetId(std::string_view name);
+    AssetId(const std::string& name) : AssetId(std::string_view(name))
+    {
+    }
+    AssetId(const char* name) : AssetId(std::string_view(name))
     {
-        return id;
     }
 
-    AssetId& operator=(const AssetId& other)
+    constexpr size_t operator()() const
     {
-        id = other.id;
-        return *this;
+        return id;
     }
-    bool operator==(const AssetId& other) const
+
+    constexpr AssetId& operator=(const AssetId& other) = default;
+    constexpr bool     operator==(const AssetId& other) const
     {
         return other.id == id;
     }
 
+    /** The interned name, or the id for names never seen at runtime */
     [[nodiscard]] std::string to_string() const;
 
+    static constexpr size_t hash(std::string_view name)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (const char c : name)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
   private:
     friend class AssetBase;
     AssetId() = default;
@@ -45,7 +65,9 @@ class AssetId final
     friend std::size_t std::hash<AssetId>::operator()(const AssetId& other) const noexcept;
 
     size_t id;
-#ifdef _DEBUG
-    std::string asset_name;
-#endif
 };
+
+consteval AssetId operator""_asset(const char* name, size_t length)
+{
+    return AssetId(AssetId::hash(std::string_view(name, length)));
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "asset_base.h"
+
+/**
+ * Assets declared with their dependencies, created in dependency order by load().
+ * Independent branches are created in parallel on the job system. Dependencies outside of the graph must already exist.
+ * Declaring dependencies on assets referenced lazily by id (ie. framebuffer images bound to a shader) is not needed.
+ * Assets are created on the workers : their constructors must only record commands through command_pool::get(), which gives each thread its own pool.
+ */
+class AssetLoadGraph final
+{
+  public:
+    struct LoadReport
+    {
+        std::vector<AssetId> critical_path;          // Longest chain of dependent assets, in creation order
+        uint64_t             critical_path_time = 0; // ns
+        uint64_t             total_time         = 0; // ns, sum of every asset creation time
+        uint64_t             elapsed_time       = 0; // ns
+        size_t               failed_assets      = 0; // Assets that failed to be created, or whose dependencies failed
+    };
+
+    /** Create asset_id with AssetManager::create<AssetClass>(asset_id, args...) once its dependencies are loaded */
+    template <class AssetClass, typename... Args> void add(const AssetId& asset_id, std::initializer_list<AssetId> dependencies, Args... args)
+    {
+        add_custom(asset_id, dependencies, [asset_id, ... arguments = std::move(args)]() mutable { return static_cast<bool>(AssetManager::get()->create<AssetClass>(asset_id, std::move(arguments)...)); });
+    }
+
+    /** Create asset_id with a custom function, returning false on failure */
+    void add_custom(const AssetId& asset_id, std::initializer_list<AssetId> dependencies, std::function<bool()> create_function);
+
+    /**
+     * Create every asset of the graph and wait for completion. Logs the critical path.
+     * Nothing is created if the graph has a cycle or a missing dependency.
+     */
+    bool load();
+
+    [[nodiscard]] const LoadReport& get_report() const
+    {
+        return report;
+    }
+
+  private:
+    struct Node
+    {
+        AssetId               id;
+        std::string           name;
+        std::vector<AssetId>  dependencies;
+        std::vector<size_t>   predecessors; // Dependencies inside of the graph
+        std::function<bool()> create_function;
+        uint64_t              duration  = 0;
+        bool                  succeeded = false;
+    };
+
+    // Sort nodes so that dependencies come first. Logs the first cycle found
+    bool sort_nodes(std::vector<size_t>& sorted_nodes) const;
+    void build_report(const std::vector<size_t>& sorted_nodes, uint64_t elapsed_time);
+
+    std::vector<Node>                   nodes;
+    std::unordered_map<AssetId, size_t> node_indices;
+    LoadReport                          report;
+};
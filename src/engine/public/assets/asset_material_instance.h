@@ -20,7 +20,7 @@ class AMaterialInstance : public AssetBase
     void update_descriptor_sets(const std::string& render_pass, NCamera* in_camera, uint32_t imageIndex);
 
     [[nodiscard]] std::vector<DescriptorSetsState>* get_descriptor_sets(const std::string& render_pass);
-    [[nodiscard]] TAssetPtr<AMaterialBase>   get_material_base() const
+    [[nodiscard]] const TAssetPtr<AMaterialBase>& get_material_base() const
     {
         return base_material;
     }
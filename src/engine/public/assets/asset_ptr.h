@@ -1,54 +1,81 @@
 #pragma once
 
-#include <memory>
+#include <cstdint>
 
 #include "asset_id.h"
 
 class AssetBase;
 
+enum class AssetLoadState : uint8_t
+{
+    Missing, // Never created, or removed
+    Loading,
+    Ready,
+    Failed,
+};
+
+/**
+ * Reference counted handle to an asset : the asset id and a generational index into the asset table of the AssetManager.
+ * Copies only touch the reference count of the slot. Handles built from an id resolve lazily, the first time get() finds the asset.
+ * Handles to an asset that is not Ready yet resolve to nullptr (see AssetManager::create_async()).
+ * Once the asset is removed from the manager, handles become stale : get() releases it and resolves again by id (ie. to a recreated asset with the same id).
+ * Stored handles must be resolved through get() on the handle itself : copies and const accessors never release a stale reference.
+ * The asset is deleted when it has been removed and the last handle referencing it is released.
+ */
 class IAssetPtr
 {
   public:
-    IAssetPtr();
+    IAssetPtr() = default;
     IAssetPtr(const AssetId& in_asset_id);
     IAssetPtr(AssetBase* in_asset);
     explicit IAssetPtr(const IAssetPtr& other);
     explicit IAssetPtr(IAssetPtr&& other) noexcept;
-    virtual ~IAssetPtr();
+    ~IAssetPtr();
 
     void set(AssetBase* in_asset);
     void set(const AssetId& in_asset_id);
     void clear();
 
     [[nodiscard]] AssetBase* get();
+    /** Doesn't keep the resolved asset : prefer get() when possible */
     [[nodiscard]] AssetBase* get_const() const;
     [[nodiscard]] AssetId    id() const
     {
-        return *asset_id.get();
+        return asset_id;
     }
-    [[nodiscard]] std::string to_string() const;
+    [[nodiscard]] std::string    to_string() const;
+    [[nodiscard]] AssetLoadState get_load_state() const;
 
     bool operator!() const
     {
-        return !asset;
+        return !get_const();
     }
 
-    void operator=(const IAssetPtr& other);
+    IAssetPtr& operator=(const IAssetPtr& other);
+    IAssetPtr& operator=(IAssetPtr&& other) noexcept;
 
     explicit operator bool() const
     {
-        return asset && asset_id;
+        return get_const();
     }
 
   private:
-    void unbind();
-    void bind();
-    void on_delete_asset(AssetBase* deleted_asset);
+    static constexpr size_t   NULL_ID      = 0;
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
 
-    std::shared_ptr<AssetId> asset_id = nullptr;
-    AssetBase*               asset    = nullptr;
+    // Take a reference on the slot of in_asset. Fails if the asset is already being deleted
+    bool acquire(AssetBase* in_asset);
+    void release();
+    // The referenced asset, or nullptr if this handle is unresolved, stale or the asset is not ready
+    [[nodiscard]] AssetBase* get_referenced() const;
+
+    AssetId  asset_id   = NULL_ID;
+    uint32_t slot_index = INVALID_SLOT;
+    uint32_t generation = 0;
 };
 
+static_assert(sizeof(IAssetPtr) == 16);
+
 template <class AssetClass> class TAssetPtr final : public IAssetPtr
 {
   public:
@@ -1,6 +1,7 @@
 #pragma once
 #include "rendering/vulkan/shader_buffer.h"
 #include "asset_base.h"
+#include "memory_tracker.h"
 #include <cstring>
 
 #define GLM_FORCE_LEFT_HANDED
@@ -24,6 +25,11 @@ class AShaderBuffer : public AssetBase
             resize_buffer(16);
     }
 
+    ~AShaderBuffer() override
+    {
+        memory::free(data);
+    }
+
     template <typename Struct_T> void set_data(const Struct_T& in_data)
     {
         resize_buffer(sizeof(Struct_T));
@@ -40,7 +46,7 @@ class AShaderBuffer : public AssetBase
         if (data_size != in_data_size)
         {
             data_size = in_data_size;
-            data      = realloc(data, data_size);
+            data      = memory::realloc(data, data_size, MemoryTag::ShaderBuffer);
         }
     }
 
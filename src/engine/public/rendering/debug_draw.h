@@ -33,7 +33,7 @@ class DebugDraw final
 
     size_t buffer_memory_alignment = 256;
 
-    FastMutex write_lock;
+    FastMutex write_lock{"debug draw"};
 
     NCamera* context_camera = nullptr;
 };
@@ -17,7 +17,7 @@ class AShader;
 struct TextureProperty
 {
     std::string         binding_name = "";
-    TAssetPtr<ATexture> texture      = TAssetPtr<ATexture>("default_texture");
+    TAssetPtr<ATexture> texture      = TAssetPtr<ATexture>("default_texture"_asset);
 };
 
 class BufferProperty final
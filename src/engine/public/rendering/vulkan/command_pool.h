@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <thread>
 
 #include "common.h"
@@ -15,19 +16,21 @@ class CommandPool final
 
     [[nodiscard]] VkCommandPool& get();
 
-    explicit operator bool();
+    // True if the calling thread owns this pool
+    [[nodiscard]] bool is_owned() const;
+    // Give this pool to the calling thread. Fails if another thread already owns it
+    bool try_claim();
 
   private:
-    bool            is_created  = false;
-    VkCommandPool   commandPool = VK_NULL_HANDLE;
-    VkDevice        pool_logical_device;
-    std::thread::id pool_thread_id;
+    VkCommandPool                commandPool = VK_NULL_HANDLE;
+    VkDevice                     pool_logical_device;
+    std::atomic<std::thread::id> pool_thread_id;
 };
 
 class Container final
 {
   public:
-    Container();
+    Container(VkDevice logical_device, uint32_t queue);
     ~Container();
 
     [[nodiscard]] VkCommandPool& get();
@@ -40,6 +43,11 @@ class Container final
     const uint32_t context_queue;
 };
 
+/**
+ * Command pools must be externally synchronized : each thread records into its own pool, claimed the first time it needs one.
+ * Pools are created once the workers exist : one per worker, plus one for the main thread.
+ */
+void create_pools(VkDevice logical_device, uint32_t queue);
 VkCommandPool& get();
 
 void destroy_pools();
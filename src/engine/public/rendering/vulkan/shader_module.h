@@ -1,6 +1,7 @@
 #pragma once
 
 #include "shader_structures.h"
+#include "memory_tracker.h"
 #include "types/fast_mutex.h"
 
 #include <optional>
@@ -11,6 +11,8 @@
 
 #include <cpputils/simplemacros.hpp>
 
+#include "jobSystem/task.h"
+
 #if CXX_MSVC
 #define VK_ENSURE(condition, ...)                              \
     if ((condition) != VK_SUCCESS)                             \
@@ -60,4 +62,7 @@ void                     end_single_time_commands(VkCommandBuffer commandBuffer)
 void                     create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
 void                     copy_buffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
 void                     create_vma_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VmaAllocation& allocation, VmaAllocationInfo& allocInfos);
+
+/** co_await wait_fence_async(fence) : the fence is waited for from a background job, the awaiting coroutine's worker stays free meanwhile */
+job_system::Task<void> wait_fence_async(VkFence fence);
 } // namespace vulkan_utils
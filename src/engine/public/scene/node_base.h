@@ -32,6 +32,11 @@ class NodeBase
         return render_scene;
     }
 
+    /**
+     * Called once per frame by Scene::tick, which ticks the nodes of a scene in parallel on the job system workers.
+     * Overrides may run concurrently with the tick of any other node : they should only modify their own node, and synchronize any access
+     * to shared state (other nodes, global data). Nodes must not be added to the scene while it is ticking.
+     */
     virtual void tick(const double delta_second)
     {
     }
@@ -23,6 +23,7 @@ class Scene
   public:
     Scene();
 
+    /** Ticks every node in parallel on the job system workers (see NodeBase::tick) */
     void tick(const double delta_second);
 
     template <typename Node_T, typename... Args_T> std::shared_ptr<Node_T> add_node(const std::string& node_name, Args_T&&... arguments)
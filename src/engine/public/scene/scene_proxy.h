@@ -1,7 +1,10 @@
 #pragma once
 
+#include "memory_tracker.h"
 #include "statsRecorder.h"
+#include "jobSystem/parallel_for.h"
 #include "rendering/renderer/swapchain.h"
+#include "types/slot_map.h"
 
 #include <cpputils/logger.hpp>
 
@@ -49,17 +52,19 @@ template <typename Struct_T> class TSceneProxyEntityGroup final : public ISceneP
 
     ~TSceneProxyEntityGroup()
     {
-        if (data)
-            free(data);
+        memory::free(sorted_data);
     }
 
     void initialize_buffer(Frustum* in_frustum) override
     {
+        const size_t element_count = entities.size();
+        Struct_T*    data          = entities.data();
+
         // resize sorted data
         if (sorted_data_memory_count < element_count || !sorted_data_memory_count)
         {
             sorted_data_memory_count = element_count + MIN_REALLOC_SIZE;
-            Struct_T* new_memory     = static_cast<Struct_T*>(realloc(sorted_data, sorted_data_memory_count * sizeof(Struct_T)));
+            Struct_T* new_memory     = static_cast<Struct_T*>(memory::realloc(sorted_data, sorted_data_memory_count * sizeof(Struct_T), MemoryTag::SceneProxy));
             if (!new_memory)
             {
                 LOG_ERROR("failed to allocate memory for sorted entity data");
@@ -67,11 +72,14 @@ template <typename Struct_T> class TSceneProxyEntityGroup final : public ISceneP
             sorted_data = new_memory;
         }
 
-        // collect mesh to render
+        // test visibility in parallel, then collect mesh to render
+        visibility.resize(element_count);
+        job_system::parallel_for<size_t>(0, element_count, 256, [this, data, in_frustum](size_t i) { visibility[i] = data[i].display_test(in_frustum); });
+
         sorted_data_count = 0;
         for (size_t i = 0; i < element_count; ++i)
         {
-            if (data[i].display_test(in_frustum)) // should display
+            if (visibility[i]) // should display
             {
                 sorted_data[sorted_data_count++] = data[i];
             }
@@ -121,133 +129,39 @@ template <typename Struct_T> class TSceneProxyEntityGroup final : public ISceneP
 
     EntityHandle add_entity(const Struct_T& new_element)
     {
-        size_t new_element_id = element_count;
-
-        resize(element_count + 1);
-        Struct_T* new_entity_ptr = &data[new_element_id];
-        memcpy(new_entity_ptr, &new_element, sizeof(Struct_T));
-
-        size_t new_entity_handle                = create_new_entity_handle();
-        handle_to_entity_map[new_entity_handle] = new_entity_ptr;
-        entity_to_handle_map[new_entity_ptr]    = new_entity_handle;
-
         return {
-            .entity_id = new_entity_handle,
+            .entity_id = entities.insert(new_element).pack(),
             .type_hash = typeid(Struct_T).hash_code(),
         };
     }
 
     void remove_entity(const EntityHandle& in_handle) override
     {
-        if (element_count > 0)
+        if (!entities.erase(SlotHandle::unpack(in_handle.entity_id)))
         {
-            Struct_T* erased_entity_ptr  = get_entity(in_handle);
-            Struct_T* last_entity_ptr    = &data[element_count - 1];
-            size_t    last_entity_handle = entity_to_handle_map[last_entity_ptr];
-
-            if (!erased_entity_ptr)
-            {
-                LOG_WARNING("failed to find entity");
-            }
-            else
-            {
-                memcpy(erased_entity_ptr, last_entity_ptr, sizeof(Struct_T));
-                handle_to_entity_map.erase(in_handle.entity_id);
-                handle_to_entity_map[last_entity_handle] = erased_entity_ptr;
-                entity_to_handle_map.erase(last_entity_ptr);
-                entity_to_handle_map[erased_entity_ptr] = last_entity_handle;
-                resize(element_count - 1);
-            }
+            LOG_WARNING("failed to find entity");
         }
     }
 
     Struct_T* get_entity(const EntityHandle& in_handle)
     {
-        auto entity = handle_to_entity_map.find(in_handle.entity_id);
-        if (entity != handle_to_entity_map.end())
-            return entity->second;
-        return nullptr;
+        return entities.get(SlotHandle::unpack(in_handle.entity_id));
     }
 
     [[nodiscard]] size_t get_component_count() const override
     {
-        return element_count;
+        return entities.size();
     }
 
   private:
-    void resize(size_t in_elem_count)
-    {
-        element_count = in_elem_count;
-
-        if (allocated_size >= MIN_REALLOC_SIZE && in_elem_count < MIN_REALLOC_SIZE)
-            return;
-
-        if (in_elem_count == 0 && data)
-        {
-            free(data);
-            data           = nullptr;
-            allocated_size = 0;
-            return;
-        }
-
-        if (in_elem_count > allocated_size || static_cast<int64_t>(in_elem_count) < static_cast<int64_t>(allocated_size) - static_cast<int64_t>(2 * MIN_REALLOC_SIZE))
-        {
-            const size_t new_allocated_size  = in_elem_count + MIN_REALLOC_SIZE;
-            void*        previous_entity_ptr = data;
-
-            size_t    new_memory_size = new_allocated_size * sizeof(Struct_T);
-            Struct_T* data_storage    = static_cast<Struct_T*>(realloc(data, new_memory_size));
-            if (!data_storage)
-            {
-                LOG_FATAL("failed to resize proxy buffer size to %lu (for %lu elements)", new_allocated_size, in_elem_count);
-            }
-
-            data           = data_storage;
-            allocated_size = new_allocated_size;
-
-            if (data != previous_entity_ptr)
-            {
-                void*         new_entity_ptr = data;
-                const int64_t offset         = (reinterpret_cast<int64_t>(new_entity_ptr) - reinterpret_cast<int64_t>(previous_entity_ptr));
-                for (auto& entity : handle_to_entity_map)
-                {
-                    uint64_t new_position = reinterpret_cast<uint64_t>(entity.second) + offset;
-                    entity.second         = reinterpret_cast<Struct_T*>(new_position);
-                }
-
-                std::unordered_map<Struct_T*, size_t> temp_map;
-                for (const auto& handle : entity_to_handle_map)
-                {
-                    uint64_t new_position                               = reinterpret_cast<uint64_t>(handle.first) + offset;
-                    temp_map[reinterpret_cast<Struct_T*>(new_position)] = handle.second;
-                }
-                entity_to_handle_map = temp_map;
-            }
-        }
-    }
-
-    size_t entity_map_random_handle = 0;
-
-    [[nodiscard]] size_t create_new_entity_handle()
-    {
-        size_t handle;
-        do
-        {
-            handle = entity_map_random_handle++;
-        } while (handle_to_entity_map.contains(handle));
-        return handle;
-    }
-
-    Struct_T*                                data                     = nullptr;
-    Struct_T*                                sorted_data              = nullptr;
-    size_t                                   element_count            = 0;
-    size_t                                   allocated_size           = 0;
-    size_t                                   sorted_data_count        = 0;
-    size_t                                   sorted_data_memory_count = 0;
-    const ProxyFunctionType<Struct_T>        proxy_function;
-    const ComponentTransformGetter<Struct_T> component_transform_getter;
-    std::unordered_map<size_t, Struct_T*>    handle_to_entity_map;
-    std::unordered_map<Struct_T*, size_t>    entity_to_handle_map;
+    // Entities are packed : visibility tests run over a contiguous array, and handles don't need fixing when it moves
+    TSlotMap<Struct_T, memory::TTaggedAllocator<Struct_T, MemoryTag::SceneProxy>> entities;
+    Struct_T*                                                                    sorted_data              = nullptr;
+    size_t                                                                       sorted_data_count        = 0;
+    size_t                                                                       sorted_data_memory_count = 0;
+    const ProxyFunctionType<Struct_T>                                            proxy_function;
+    const ComponentTransformGetter<Struct_T>                                     component_transform_getter;
+    std::vector<uint8_t>                                                         visibility;
 };
 
 class SceneProxy
@@ -255,6 +169,7 @@ class SceneProxy
   public:
     void initialize_buffer(Frustum* in_frustum)
     {
+        // Not counted : visibility is tested in parallel_for, and counters only cover the calling thread
         BEGIN_NAMED_RECORD(INITIALIZE_BUFFERS);
         for (auto& group : entity_groups)
         {
@@ -263,7 +178,7 @@ class SceneProxy
     }
     void build_transformations(AShaderBuffer* buffer_storage)
     {
-        BEGIN_NAMED_RECORD(BUILD_TRANSFORMATIONS);
+        BEGIN_COUNTED_RECORD(BUILD_TRANSFORMATIONS);
         size_t item_index = 0;
         for (auto& group : entity_groups)
         {
@@ -24,6 +24,14 @@ class ProfilerWindow : public WindowBase
 
     void draw_profiler_history();
 
+    void draw_frame_scopes();
+
+    void draw_memory_stats();
+
+    void draw_telemetry();
+
+    void draw_lock_stats();
+
     struct ThreadInfo
     {
         std::vector<Profiler::Stat> thread_stats;
@@ -41,6 +49,6 @@ class ProfilerWindow : public WindowBase
     int64_t                                                                 max_awaiting_job, max_total_job;
 
     std::chrono::steady_clock::time_point           last_thread_survey;
-    std::unordered_map<std::thread::id, ThreadInfo> infos;
+    std::unordered_map<uint32_t, ThreadInfo>        infos;
     double                                          time_to_local(const record_clock::time_point& time);
 };
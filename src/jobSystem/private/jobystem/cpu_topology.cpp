@@ -0,0 +1,189 @@
+#include "jobSystem/cpu_topology.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <tuple>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace job_system
+{
+
+#if defined(__linux__)
+static std::string read_text(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    std::string   text;
+    std::getline(file, text);
+    return text;
+}
+
+static uint32_t read_uint(const std::filesystem::path& path, uint32_t default_value)
+{
+    const std::string text = read_text(path);
+    if (text.empty())
+        return default_value;
+    try
+    {
+        return static_cast<uint32_t>(std::stoul(text));
+    }
+    catch (const std::exception&)
+    {
+        return default_value;
+    }
+}
+
+// Parse sysfs cpu lists such as "0-3,8-11,16"
+static std::vector<uint32_t> parse_cpu_list(const std::string& text)
+{
+    std::vector<uint32_t> result;
+    size_t                position = 0;
+    while (position < text.size())
+    {
+        size_t end = text.find(',', position);
+        if (end == std::string::npos)
+            end = text.size();
+        const std::string range = text.substr(position, end - position);
+        position                = end + 1;
+        if (range.empty())
+            continue;
+
+        try
+        {
+            const size_t   separator = range.find('-');
+            const uint32_t first     = static_cast<uint32_t>(std::stoul(range.substr(0, separator)));
+            const uint32_t last      = separator == std::string::npos ? first : static_cast<uint32_t>(std::stoul(range.substr(separator + 1)));
+            for (uint32_t cpu = first; cpu <= last; ++cpu)
+                result.emplace_back(cpu);
+        }
+        catch (const std::exception&)
+        {
+        }
+    }
+    return result;
+}
+#endif
+
+CpuTopology CpuTopology::detect()
+{
+    CpuTopology topology;
+
+#if defined(__linux__)
+    const std::filesystem::path cpu_root = "/sys/devices/system/cpu";
+    for (const uint32_t cpu_id : parse_cpu_list(read_text(cpu_root / "online")))
+    {
+        const std::filesystem::path cpu_path = cpu_root / ("cpu" + std::to_string(cpu_id)) / "topology";
+        LogicalCpu&                 cpu      = topology.cpus.emplace_back();
+        cpu.cpu_id                           = cpu_id;
+        cpu.core_id                          = read_uint(cpu_path / "core_id", cpu_id);
+        cpu.package_id                       = read_uint(cpu_path / "physical_package_id", 0);
+    }
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 || !std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; }))
+            continue;
+
+        const uint32_t node = static_cast<uint32_t>(std::stoul(name.substr(4)));
+        for (const uint32_t cpu_id : parse_cpu_list(read_text(entry.path() / "cpulist")))
+            for (LogicalCpu& cpu : topology.cpus)
+                if (cpu.cpu_id == cpu_id)
+                    cpu.numa_node = node;
+    }
+#endif
+
+    if (topology.cpus.empty())
+    {
+        const uint32_t cpu_count = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t i = 0; i < cpu_count; ++i)
+            topology.cpus.emplace_back(LogicalCpu{.cpu_id = i, .core_id = i});
+    }
+
+    topology.finalize();
+    return topology;
+}
+
+void CpuTopology::finalize()
+{
+    // core_id is only unique inside its package
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> core_indices;
+    for (LogicalCpu& cpu : cpus)
+    {
+        const auto [it, inserted] = core_indices.emplace(std::pair{cpu.package_id, cpu.core_id}, static_cast<uint32_t>(core_indices.size()));
+        cpu.core_id               = it->second;
+    }
+
+    std::sort(cpus.begin(), cpus.end(), [](const LogicalCpu& a, const LogicalCpu& b) { return std::tie(a.numa_node, a.core_id, a.cpu_id) < std::tie(b.numa_node, b.core_id, b.cpu_id); });
+
+    uint32_t max_node = 0, max_package = 0;
+    for (size_t i = 0; i < cpus.size(); ++i)
+    {
+        cpus[i].is_smt_sibling = i > 0 && cpus[i - 1].core_id == cpus[i].core_id;
+        max_node               = std::max(max_node, cpus[i].numa_node);
+        max_package            = std::max(max_package, cpus[i].package_id);
+    }
+    physical_core_count = static_cast<uint32_t>(core_indices.size());
+    numa_node_count     = max_node + 1;
+    package_count       = max_package + 1;
+}
+
+std::vector<CpuTopology::LogicalCpu> CpuTopology::select_worker_cpus(size_t worker_count, bool smt_siblings) const
+{
+    std::vector<LogicalCpu> candidates;
+    for (const LogicalCpu& cpu : cpus)
+        if (!cpu.is_smt_sibling)
+            candidates.emplace_back(cpu);
+    if (smt_siblings)
+        for (const LogicalCpu& cpu : cpus)
+            if (cpu.is_smt_sibling)
+                candidates.emplace_back(cpu);
+
+    // Keep consecutive workers on the same node
+    std::stable_sort(candidates.begin(), candidates.end(), [](const LogicalCpu& a, const LogicalCpu& b) { return a.numa_node < b.numa_node; });
+
+    std::vector<LogicalCpu> selection;
+    selection.reserve(worker_count);
+    for (size_t i = 0; i < worker_count && !candidates.empty(); ++i)
+        selection.emplace_back(candidates[i % candidates.size()]);
+    return selection;
+}
+
+std::string CpuTopology::to_string() const
+{
+    return std::to_string(package_count) + " package(s), " + std::to_string(numa_node_count) + " NUMA node(s), " + std::to_string(physical_core_count) + " physical core(s), " +
+           std::to_string(cpus.size()) + " logical cpu(s)";
+}
+
+bool CpuTopology::pin_current_thread(uint32_t cpu_id)
+{
+#if defined(__linux__)
+    const size_t cpu_count = static_cast<size_t>(cpu_id) + 1;
+    cpu_set_t*   cpu_set   = CPU_ALLOC(cpu_count);
+    if (!cpu_set)
+        return false;
+    const size_t set_size = CPU_ALLOC_SIZE(cpu_count);
+    CPU_ZERO_S(set_size, cpu_set);
+    CPU_SET_S(cpu_id, set_size, cpu_set);
+    const bool success = pthread_setaffinity_np(pthread_self(), set_size, cpu_set) == 0;
+    CPU_FREE(cpu_set);
+    return success;
+#elif defined(_WIN32)
+    if (cpu_id >= 64)
+        return false;
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu_id) != 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace job_system
@@ -0,0 +1,156 @@
+#include "fiber.h"
+
+#include "memory_tracker.h"
+
+#include <cpputils/logger.hpp>
+#include <cstdint>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace job_system
+{
+
+thread_local Fiber* current_fiber = nullptr;
+
+#if defined(_WIN32)
+thread_local void* thread_return_fiber = nullptr;
+#else
+thread_local ucontext_t* thread_return_context = nullptr;
+#endif
+
+Fiber::Fiber(size_t in_stack_size, Entry in_entry) : entry(in_entry)
+{
+#if defined(_WIN32)
+    handle = CreateFiber(in_stack_size, &Fiber::win32_entry, this);
+    if (!handle)
+        LOG_FATAL("failed to create fiber");
+#else
+    // One guard page below the stack turns overflows into segfaults instead of silent corruptions
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    stack_size             = (in_stack_size + page_size - 1) / page_size * page_size + page_size;
+    stack                  = mmap(nullptr, stack_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (stack == MAP_FAILED)
+        LOG_FATAL("failed to allocate fiber stack");
+    mprotect(stack, page_size, PROT_NONE);
+    memory::track_allocation(MemoryTag::JobSystem, stack_size);
+
+    getcontext(&context);
+    context.uc_stack.ss_sp   = static_cast<uint8_t*>(stack) + page_size;
+    context.uc_stack.ss_size = stack_size - page_size;
+    context.uc_link          = nullptr;
+    const uintptr_t self     = reinterpret_cast<uintptr_t>(this);
+    makecontext(&context, reinterpret_cast<void (*)()>(&Fiber::posix_entry), 2, static_cast<unsigned int>(self & 0xFFFFFFFF), static_cast<unsigned int>(static_cast<uint64_t>(self) >> 32));
+#endif
+}
+
+Fiber::~Fiber()
+{
+#if defined(_WIN32)
+    DeleteFiber(handle);
+#else
+    munmap(stack, stack_size);
+    memory::track_free(MemoryTag::JobSystem, stack_size);
+#endif
+}
+
+void Fiber::resume()
+{
+    Fiber*                     previous_fiber       = current_fiber;
+    FrameProfiler::ScopeStack* previous_scope_stack = FrameProfiler::swap_scope_stack(&scope_stack);
+    current_fiber                                   = this;
+    state                                           = State::Running;
+#if defined(_WIN32)
+    if (!thread_return_fiber)
+        thread_return_fiber = ConvertThreadToFiber(nullptr);
+    void* previous_return = thread_return_fiber;
+    thread_return_fiber   = GetCurrentFiber();
+    SwitchToFiber(handle);
+    thread_return_fiber = previous_return;
+#else
+    ucontext_t  return_context;
+    ucontext_t* previous_return = thread_return_context;
+    thread_return_context       = &return_context;
+    swapcontext(&return_context, &context);
+    thread_return_context = previous_return;
+#endif
+    current_fiber = previous_fiber;
+    FrameProfiler::swap_scope_stack(previous_scope_stack);
+}
+
+void Fiber::yield_to_thread()
+{
+    Fiber* fiber = current_fiber;
+#if defined(_WIN32)
+    SwitchToFiber(thread_return_fiber);
+#else
+    swapcontext(&fiber->context, thread_return_context);
+#endif
+}
+
+Fiber* Fiber::current()
+{
+    return current_fiber;
+}
+
+void Fiber::on_job_complete()
+{
+    Worker::schedule_fiber(this);
+}
+
+#if defined(_WIN32)
+void __stdcall Fiber::win32_entry(void* fiber)
+{
+    Fiber* self = static_cast<Fiber*>(fiber);
+    self->entry(self);
+}
+#else
+void Fiber::posix_entry(unsigned int low, unsigned int high)
+{
+    Fiber* self = reinterpret_cast<Fiber*>(static_cast<uintptr_t>(low) | static_cast<uintptr_t>(static_cast<uint64_t>(high) << 32));
+    self->entry(self);
+}
+#endif
+
+FiberPool::FiberPool(size_t fiber_count, size_t stack_size, Fiber::Entry entry)
+{
+    fibers.reserve(fiber_count);
+    for (size_t i = 0; i < fiber_count; ++i)
+        fibers.emplace_back(new Fiber(stack_size, entry));
+    free_fibers = fibers;
+}
+
+FiberPool::~FiberPool()
+{
+    if (free_fibers.size() != fibers.size())
+        LOG_ERROR("destroying fiber pool while %zu fibers are still in use", fibers.size() - free_fibers.size());
+    for (const Fiber* fiber : fibers)
+        delete fiber;
+}
+
+Fiber* FiberPool::acquire()
+{
+    std::lock_guard lock(free_fibers_lock);
+    if (free_fibers.empty())
+        return nullptr;
+    Fiber* fiber = free_fibers.back();
+    free_fibers.pop_back();
+    return fiber;
+}
+
+void FiberPool::release(Fiber* fiber)
+{
+    fiber->state             = Fiber::State::Idle;
+    fiber->task              = nullptr;
+    fiber->current_task      = nullptr;
+    fiber->awaited_task      = nullptr;
+    fiber->scope_stack.depth = 0;
+    std::lock_guard lock(free_fibers_lock);
+    free_fibers.emplace_back(fiber);
+}
+
+} // namespace job_system
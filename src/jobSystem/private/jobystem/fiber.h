@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "frame_profiler.h"
+#include "jobSystem/job.h"
+
+#if !defined(_WIN32)
+#include <ucontext.h>
+#endif
+
+namespace job_system
+{
+
+/**
+ * Execution context with its own stack. Jobs running on a fiber can be suspended while they wait, freeing the worker thread for other jobs.
+ * A suspended fiber may be resumed by any worker.
+ */
+class Fiber final : public IJobWaiter
+{
+  public:
+    using Entry = void (*)(Fiber*);
+
+    enum class State
+    {
+        Idle,
+        Running,
+        Finished,        // The job is done : the fiber can go back to the pool
+        WaitingJob,      // Suspended until awaited_task completes
+        WaitingChildren, // Suspended until the children of awaited_task complete
+    };
+
+    Fiber(size_t stack_size, Entry entry);
+    ~Fiber();
+
+    Fiber(const Fiber&)            = delete;
+    Fiber& operator=(const Fiber&) = delete;
+
+    /** Switch from the calling thread to this fiber, until it yields */
+    void resume();
+
+    /** Suspend the fiber running on the calling thread and return to the thread that resumed it */
+    static void yield_to_thread();
+
+    /** Fiber running on the calling thread, or nullptr */
+    static Fiber* current();
+
+    /** The awaited job completed : resume this fiber on the first available worker */
+    void on_job_complete() override;
+
+    State     state        = State::Idle;
+    IJobTask* task         = nullptr; // Job this fiber was started for
+    IJobTask* current_task = nullptr; // Innermost job running on this fiber (jobs may be executed inline)
+    IJobTask* awaited_task = nullptr;
+
+    // Profiler scopes opened by the jobs of this fiber : they follow the fiber from one worker to another
+    FrameProfiler::ScopeStack scope_stack;
+
+  private:
+#if defined(_WIN32)
+    static void __stdcall win32_entry(void* fiber);
+
+    void* handle = nullptr;
+#else
+    static void posix_entry(unsigned int low, unsigned int high);
+
+    ucontext_t context;
+    void*      stack      = nullptr;
+    size_t     stack_size = 0;
+#endif
+    Entry entry;
+};
+
+/**
+ * Fixed set of fibers with their stacks, allocated up front
+ */
+class FiberPool final
+{
+  public:
+    FiberPool(size_t fiber_count, size_t stack_size, Fiber::Entry entry);
+    ~FiberPool();
+
+    /** Returns nullptr when every fiber is in use */
+    Fiber* acquire();
+    void   release(Fiber* fiber);
+
+    [[nodiscard]] size_t get_fiber_count() const
+    {
+        return fibers.size();
+    }
+
+  private:
+    std::vector<Fiber*> fibers;
+    std::vector<Fiber*> free_fibers;
+    std::mutex          free_fibers_lock;
+};
+
+} // namespace job_system
@@ -1,15 +1,33 @@
 
-
 #include "jobSystem/job.h"
 
-#include <memory>
+#include "fiber.h"
+
+#include <utility>
 
 namespace job_system {
 
-	int64_t stat_awaiting_jobs = 0;
-	int64_t stat_total_job = 0;
-	
-	std::shared_ptr<IJobTask> IJobTask::find_current_parent_task()
+	// Marks the waiter list of a completed job
+	static IJobWaiter* const CLOSED_WAITER_LIST = reinterpret_cast<IJobWaiter*>(uintptr_t(1));
+
+	// Job counters are sharded per thread : a single shared counter would bounce between every worker on each job
+	struct alignas(64) JobCounterShard
+	{
+		std::atomic_int64_t total_jobs = 0;
+		std::atomic_int64_t awaiting_jobs = 0;
+	};
+
+	static constexpr size_t JOB_COUNTER_SHARDS = 64;
+	JobCounterShard job_counter_shards[JOB_COUNTER_SHARDS];
+	std::atomic_uint32_t next_job_counter_shard = 0;
+
+	static JobCounterShard& get_job_counter_shard()
+	{
+		thread_local JobCounterShard& shard = job_counter_shards[next_job_counter_shard.fetch_add(1, std::memory_order_relaxed) % JOB_COUNTER_SHARDS];
+		return shard;
+	}
+
+	IJobTask* IJobTask::find_current_parent_task()
 	{
 		if (Worker* worker = Worker::get())
 		{
@@ -20,27 +38,163 @@ namespace job_system {
 
 	int64_t IJobTask::get_stat_total_job_count()
 	{
-		return stat_total_job;
+		int64_t total = 0;
+		for (const JobCounterShard& shard : job_counter_shards)
+			total += shard.total_jobs.load(std::memory_order_relaxed);
+		return total;
 	}
 
 	int64_t IJobTask::get_stat_awaiting_job_count()
 	{
-		return stat_awaiting_jobs;
+		int64_t total = 0;
+		for (const JobCounterShard& shard : job_counter_shards)
+			total += shard.awaiting_jobs.load(std::memory_order_relaxed);
+		return total;
+	}
+
+	void IJobTask::wait_children()
+	{
+		// Fiber mode : suspend until the last child completes
+		if (Fiber* fiber = Fiber::current())
+		{
+			while (unfinished.load(std::memory_order_acquire) > 1)
+			{
+				fiber->awaited_task = this;
+				fiber->state = Fiber::State::WaitingChildren;
+				Fiber::yield_to_thread();
+			}
+			return;
+		}
+
+		// Only the job body itself is left once every child completed
+		while (unfinished.load(std::memory_order_acquire) > 1)
+		{
+			Worker::help_or_yield();
+		}
+	}
+
+	void IJobTask::wait()
+	{
+		if (Fiber* fiber = Fiber::current())
+		{
+			while (!complete.load(std::memory_order_acquire))
+			{
+				fiber->awaited_task = this;
+				fiber->state = Fiber::State::WaitingJob;
+				Fiber::yield_to_thread();
+			}
+		}
+		else if (Worker::get())
+		{
+			while (!complete.load(std::memory_order_acquire))
+			{
+				Worker::help_or_yield();
+			}
+		}
+		else
+		{
+			blocked_waiters.fetch_add(1, std::memory_order_seq_cst);
+			complete.wait(false, std::memory_order_seq_cst);
+			blocked_waiters.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	void IJobTask::register_child()
+	{
+		unfinished.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void IJobTask::finish()
+	{
+		const int64_t remaining = unfinished.fetch_sub(1, std::memory_order_seq_cst) - 1;
+		if (remaining == 1)
+		{
+			// Only the body is left : wake it up if it is suspended in wait_children()
+			if (children_waiter.load(std::memory_order_seq_cst))
+				if (IJobWaiter* waiter = children_waiter.exchange(nullptr, std::memory_order_acq_rel))
+					waiter->on_job_complete();
+			return;
+		}
+		if (remaining != 0) return;
+
+		IJobTask* parent = std::exchange(parent_task, nullptr);
+		complete.store(true, std::memory_order_seq_cst);
+		if (blocked_waiters.load(std::memory_order_seq_cst) > 0)
+			complete.notify_all();
+		if (waiters.load(std::memory_order_seq_cst))
+			notify_waiters();
+		if (parent)
+		{
+			parent->finish();
+			parent->release_reference();
+		}
+	}
+
+	void IJobTask::add_waiter(IJobWaiter* waiter)
+	{
+		IJobWaiter* head = waiters.load(std::memory_order_seq_cst);
+		do
+		{
+			if (head == CLOSED_WAITER_LIST)
+			{
+				waiter->on_job_complete();
+				return;
+			}
+			waiter->next_waiter = head;
+		} while (!waiters.compare_exchange_weak(head, waiter, std::memory_order_seq_cst));
+
+		// finish() may have checked the list before we were added
+		if (complete.load(std::memory_order_seq_cst))
+			notify_waiters();
+	}
+
+	void IJobTask::set_children_waiter(IJobWaiter* waiter)
+	{
+		children_waiter.store(waiter, std::memory_order_seq_cst);
+		if (unfinished.load(std::memory_order_seq_cst) > 1)
+			return;
+
+		// The last child completed meanwhile : take the registration back, unless it already did
+		if (children_waiter.exchange(nullptr, std::memory_order_acq_rel) == waiter)
+			waiter->on_job_complete();
+	}
+
+	void IJobTask::notify_waiters()
+	{
+		IJobWaiter* waiter = waiters.exchange(CLOSED_WAITER_LIST, std::memory_order_acq_rel);
+		while (waiter && waiter != CLOSED_WAITER_LIST)
+		{
+			// The waiter may be gone as soon as it is notified
+			IJobWaiter* next = waiter->next_waiter;
+			waiter->on_job_complete();
+			waiter = next;
+		}
+	}
+
+	void IJobTask::destroy()
+	{
+		JobArena::Page* page = arena_page;
+		this->~IJobTask();
+		if (page)
+			JobArena::free(page);
+		else
+			::operator delete(this, std::align_val_t(JobArena::ALIGNMENT));
 	}
 
 	void IJobTask::inc_job_count()
 	{
-		stat_total_job++;
-		stat_awaiting_jobs++;
+		JobCounterShard& shard = get_job_counter_shard();
+		shard.total_jobs.fetch_add(1, std::memory_order_relaxed);
+		shard.awaiting_jobs.fetch_add(1, std::memory_order_relaxed);
 	}
 
 	void IJobTask::dec_awaiting_job_count()
 	{
-		stat_awaiting_jobs--;
+		get_job_counter_shard().awaiting_jobs.fetch_sub(1, std::memory_order_relaxed);
 	}
 
 	void IJobTask::dec_total_job_count()
 	{
-		stat_total_job--;
+		get_job_counter_shard().total_jobs.fetch_sub(1, std::memory_order_relaxed);
 	}
 }
@@ -0,0 +1,144 @@
+#include "jobSystem/job_arena.h"
+
+#include "memory_tracker.h"
+
+#include <mutex>
+#include <new>
+
+namespace job_system
+{
+
+static constexpr size_t PAGE_HEADER_SIZE = (sizeof(JobArena::Page) + JobArena::ALIGNMENT - 1) / JobArena::ALIGNMENT * JobArena::ALIGNMENT;
+
+std::atomic_uint64_t current_frame_index = 1;
+std::atomic_size_t   total_page_count    = 0;
+
+// Arenas are never destroyed since a released thread may still have jobs alive in its pages : they are handed to the next thread instead.
+class ArenaPool
+{
+  public:
+    JobArena* acquire()
+    {
+        std::lock_guard lock(pool_lock);
+        if (free_arenas.empty())
+            return new JobArena();
+        JobArena* arena = free_arenas.back();
+        free_arenas.pop_back();
+        return arena;
+    }
+
+    void release(JobArena* arena)
+    {
+        std::lock_guard lock(pool_lock);
+        free_arenas.emplace_back(arena);
+    }
+
+  private:
+    std::mutex             pool_lock;
+    std::vector<JobArena*> free_arenas;
+};
+
+static ArenaPool& get_arena_pool()
+{
+    // Leaked on purpose : thread exits can happen after static destruction
+    static ArenaPool* pool = new ArenaPool();
+    return *pool;
+}
+
+struct ThreadArena
+{
+    ThreadArena() : arena(get_arena_pool().acquire())
+    {
+    }
+    ~ThreadArena()
+    {
+        get_arena_pool().release(arena);
+    }
+    JobArena* arena;
+};
+
+JobArena& JobArena::get()
+{
+    thread_local ThreadArena thread_arena;
+    return *thread_arena.arena;
+}
+
+void JobArena::begin_frame()
+{
+    current_frame_index.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* JobArena::allocate(size_t size, Page*& out_page)
+{
+    size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (size > MAX_ALLOCATION)
+        return nullptr;
+
+    if (const uint64_t frame = current_frame_index.load(std::memory_order_relaxed); frame != frame_index)
+    {
+        frame_index = frame;
+        rewind();
+    }
+
+    if (!current_page || PAGE_HEADER_SIZE + current_page->offset + size > PAGE_SIZE)
+        current_page = next_page();
+
+    void* memory = reinterpret_cast<uint8_t*>(current_page) + PAGE_HEADER_SIZE + current_page->offset;
+    current_page->offset += size;
+    current_page->live_allocations.fetch_add(1, std::memory_order_relaxed);
+    out_page = current_page;
+    return memory;
+}
+
+size_t JobArena::get_total_page_count()
+{
+    return total_page_count.load(std::memory_order_relaxed);
+}
+
+JobArena::~JobArena()
+{
+    for (Page* page : pages)
+    {
+        page->~Page();
+        ::operator delete(page, std::align_val_t(ALIGNMENT));
+        memory::track_free(MemoryTag::JobSystem, PAGE_SIZE);
+    }
+}
+
+void JobArena::rewind()
+{
+    for (size_t i = 0; i < pages.size(); ++i)
+    {
+        if (pages[i]->live_allocations.load(std::memory_order_acquire) == 0)
+        {
+            pages[i]->offset   = 0;
+            current_page_index = i;
+            current_page       = pages[i];
+            return;
+        }
+    }
+}
+
+JobArena::Page* JobArena::next_page()
+{
+    // Reuse the next drained page if any
+    for (size_t i = 1; i <= pages.size(); ++i)
+    {
+        const size_t index = (current_page_index + i) % pages.size();
+        if (pages[index] != current_page && pages[index]->live_allocations.load(std::memory_order_acquire) == 0)
+        {
+            pages[index]->offset = 0;
+            current_page_index   = index;
+            return pages[index];
+        }
+    }
+
+    Page* page = new (::operator new(PAGE_SIZE, std::align_val_t(ALIGNMENT))) Page();
+    memory::track_allocation(MemoryTag::JobSystem, PAGE_SIZE);
+    pages.emplace_back(page);
+    current_page_index = pages.size() - 1;
+    total_page_count.fetch_add(1, std::memory_order_relaxed);
+    return page;
+}
+
+} // namespace job_system
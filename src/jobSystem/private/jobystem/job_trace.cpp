@@ -0,0 +1,218 @@
+#include "jobSystem/job_trace.h"
+
+#include "jobSystem/job.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cpputils/logger.hpp>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace job_system::trace
+{
+
+struct ThreadBuffer
+{
+    std::unique_ptr<Event[]> events = std::make_unique<Event[]>(EVENTS_PER_THREAD);
+    // Total number of events written : the last EVENTS_PER_THREAD ones are available
+    std::atomic_uint64_t head = 0;
+    uint32_t             track_id;
+    std::string          label;
+};
+
+// Buffers outlive their thread so the capture can be exported after the workers are destroyed
+std::mutex                                 buffers_lock;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+thread_local ThreadBuffer*                 thread_buffer = nullptr;
+
+static ThreadBuffer* register_thread()
+{
+    auto buffer = std::make_unique<ThreadBuffer>();
+    if (const Worker* worker = Worker::get())
+    {
+        buffer->track_id = worker->get_worker_id();
+        buffer->label    = "worker #" + std::to_string(worker->get_worker_id());
+    }
+    else
+    {
+        buffer->label = "thread";
+    }
+
+    std::lock_guard lock(buffers_lock);
+    // Threads that are not workers get tracks after the workers
+    if (!Worker::get())
+        buffer->track_id = 100000 + static_cast<uint32_t>(buffers.size());
+    buffer->label += " (" + std::to_string(buffers.size()) + ")";
+    return buffers.emplace_back(std::move(buffer)).get();
+}
+
+void internal::record_event(EventType type, const IJobTask* job)
+{
+    if (!thread_buffer)
+        thread_buffer = register_thread();
+
+    const uint64_t index = thread_buffer->head.load(std::memory_order_relaxed);
+    Event&         event = thread_buffer->events[index % EVENTS_PER_THREAD];
+    event.timestamp      = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    event.type           = type;
+    event.job            = job;
+    event.parent         = job && (type == EventType::Enqueue || type == EventType::Start) ? job->parent_task : nullptr;
+    event.name           = job ? job->get_name() : nullptr;
+    thread_buffer->head.store(index + 1, std::memory_order_release);
+}
+
+void start()
+{
+    internal::enabled.store(true, std::memory_order_relaxed);
+}
+
+void stop()
+{
+    internal::enabled.store(false, std::memory_order_relaxed);
+}
+
+void clear()
+{
+    std::lock_guard lock(buffers_lock);
+    for (const auto& buffer : buffers)
+        buffer->head.store(0, std::memory_order_relaxed);
+}
+
+// Extract "X" from compiler generated function signatures such as "... [with Lambda = X]" or "...TJobTask<X>::get_name"
+static std::string readable_name(const char* name)
+{
+    if (!name)
+        return "job";
+    std::string text = name;
+    if (const size_t with = text.find("= "); with != std::string::npos)
+    {
+        text = text.substr(with + 2);
+        if (const size_t end = text.find_first_of(";]"); end != std::string::npos)
+            text = text.substr(0, end);
+    }
+    std::string escaped;
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+bool export_chrome_trace(const std::filesystem::path& path)
+{
+    struct TrackEvent
+    {
+        Event    event;
+        uint32_t track;
+    };
+    std::vector<TrackEvent> events;
+
+    std::ofstream output(path);
+    if (!output)
+    {
+        LOG_ERROR("cannot write job trace to %s", path.string().c_str());
+        return false;
+    }
+    output << "{\"traceEvents\":[\n";
+
+    output << R"({"name":"process_name","ph":"M","pid":1,"args":{"name":"job system"}})";
+    {
+        std::lock_guard lock(buffers_lock);
+        for (const auto& buffer : buffers)
+        {
+            output << ",\n" << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer->track_id << R"(,"args":{"name":")" << buffer->label << "\"}}";
+
+            const uint64_t head  = buffer->head.load(std::memory_order_acquire);
+            const uint64_t count = std::min<uint64_t>(head, EVENTS_PER_THREAD);
+            for (uint64_t i = head - count; i < head; ++i)
+                events.emplace_back(TrackEvent{buffer->events[i % EVENTS_PER_THREAD], buffer->track_id});
+        }
+    }
+
+    // Jobs move between threads : match events in global time order
+    std::stable_sort(events.begin(), events.end(), [](const TrackEvent& a, const TrackEvent& b) { return a.event.timestamp < b.event.timestamp; });
+    const uint64_t origin = events.empty() ? 0 : events.front().event.timestamp;
+    const auto     micros = [origin](uint64_t timestamp) { return static_cast<double>(timestamp - origin) / 1000.0; };
+
+    struct Pending
+    {
+        uint64_t        timestamp;
+        uint32_t        track;
+        uint64_t        flow_id;
+        const IJobTask* parent = nullptr;
+    };
+    std::unordered_map<const IJobTask*, Pending> enqueued;
+    std::unordered_map<const IJobTask*, Pending> started;
+    std::unordered_map<uint32_t, uint64_t>       parked;
+    uint64_t                                     next_flow_id = 1;
+
+    output.precision(3);
+    output << std::fixed;
+    for (const TrackEvent& item : events)
+    {
+        const Event& event = item.event;
+        switch (event.type)
+        {
+        case EventType::Enqueue:
+        {
+            const uint64_t flow_id = next_flow_id++;
+            enqueued[event.job]    = {event.timestamp, item.track, flow_id};
+            output << ",\n" << R"({"name":"enqueue","cat":"job","ph":"s","pid":1,"tid":)" << item.track << ",\"ts\":" << micros(event.timestamp) << ",\"id\":" << flow_id << "}";
+            break;
+        }
+        case EventType::Start:
+        {
+            uint64_t flow_id = 0;
+            if (const auto found = enqueued.find(event.job); found != enqueued.end())
+            {
+                flow_id = found->second.flow_id;
+                output << ",\n"
+                       << R"({"name":"enqueue","cat":"job","ph":"f","bp":"e","pid":1,"tid":)" << item.track << ",\"ts\":" << micros(event.timestamp) << ",\"id\":" << flow_id << "}";
+            }
+            started[event.job] = {event.timestamp, item.track, flow_id, event.parent};
+            break;
+        }
+        case EventType::End:
+        {
+            const auto found = started.find(event.job);
+            if (found == started.end())
+                break;
+            const auto   enqueue       = enqueued.find(event.job);
+            const double queue_latency = enqueue != enqueued.end() ? micros(found->second.timestamp) - micros(enqueue->second.timestamp) : 0.0;
+            output << ",\n"
+                   << R"({"name":")" << readable_name(event.name) << R"(","cat":"job","ph":"X","pid":1,"tid":)" << found->second.track << ",\"ts\":" << micros(found->second.timestamp)
+                   << ",\"dur\":" << micros(event.timestamp) - micros(found->second.timestamp) << R"(,"args":{"job":")" << event.job << R"(","parent":")" << found->second.parent << R"(","queue_latency_us":)" << queue_latency << "}}";
+            started.erase(found);
+            if (enqueue != enqueued.end())
+                enqueued.erase(enqueue);
+            break;
+        }
+        case EventType::Steal:
+            output << ",\n" << R"({"name":"steal","cat":"scheduler","ph":"i","s":"t","pid":1,"tid":)" << item.track << ",\"ts\":" << micros(event.timestamp) << R"(,"args":{"job":")" << event.job << "\"}}";
+            break;
+        case EventType::Park:
+            parked[item.track] = event.timestamp;
+            break;
+        case EventType::Unpark:
+            if (const auto found = parked.find(item.track); found != parked.end())
+            {
+                output << ",\n"
+                       << R"({"name":"parked","cat":"idle","ph":"X","pid":1,"tid":)" << item.track << ",\"ts\":" << micros(found->second) << ",\"dur\":" << micros(event.timestamp) - micros(found->second) << "}";
+                parked.erase(found);
+            }
+            break;
+        }
+    }
+
+    output << "\n]}\n";
+    LOG_INFO("exported %zu job trace events to %s", events.size(), path.string().c_str());
+    return true;
+}
+
+} // namespace job_system::trace
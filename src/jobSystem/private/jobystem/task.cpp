@@ -0,0 +1,25 @@
+#include "jobSystem/task.h"
+
+#include <fstream>
+
+namespace job_system
+{
+
+Task<std::vector<uint8_t>> read_file_async(std::filesystem::path path)
+{
+    std::vector<uint8_t> content = co_await blocking_call(
+        [&path]
+        {
+            std::vector<uint8_t> data;
+            std::ifstream        file(path, std::ios::binary | std::ios::ate);
+            if (!file)
+                return data;
+            data.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            return data;
+        });
+    co_return content;
+}
+
+} // namespace job_system
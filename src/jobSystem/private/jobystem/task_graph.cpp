@@ -0,0 +1,141 @@
+#include "jobSystem/task_graph.h"
+
+#include "jobSystem/job_system.h"
+
+#include <cpputils/logger.hpp>
+
+namespace job_system
+{
+
+TaskGraph::~TaskGraph()
+{
+    wait();
+}
+
+TaskGraph::TaskId TaskGraph::add_task(const char* name, std::function<void()> task, std::initializer_list<TaskId> predecessors)
+{
+    if (is_running())
+        LOG_FATAL("cannot modify task graph while it is running");
+
+    const TaskId task_id = tasks.size();
+    Task&        new_task = tasks.emplace_back();
+    new_task.name         = name;
+    new_task.function     = std::move(task);
+    is_dirty              = true;
+
+    for (const TaskId predecessor : predecessors)
+        add_dependency(task_id, predecessor);
+
+    return task_id;
+}
+
+void TaskGraph::add_dependency(TaskId task, TaskId predecessor)
+{
+    if (is_running())
+        LOG_FATAL("cannot modify task graph while it is running");
+    if (task >= tasks.size() || predecessor >= tasks.size())
+    {
+        LOG_ERROR("invalid task graph dependency %lu -> %lu", predecessor, task);
+        return;
+    }
+
+    tasks[predecessor].successors.emplace_back(task);
+    tasks[task].predecessor_count++;
+    is_dirty = true;
+}
+
+void TaskGraph::clear()
+{
+    wait();
+    tasks.clear();
+    roots.clear();
+    is_dirty = true;
+}
+
+JobPtr TaskGraph::submit()
+{
+    if (is_running())
+    {
+        LOG_ERROR("cannot submit task graph : previous run is not complete");
+        return {};
+    }
+
+    if (is_dirty)
+    {
+        is_valid = validate();
+        is_dirty = false;
+    }
+    if (!is_valid)
+        return {};
+
+    for (Task& task : tasks)
+        task.remaining_predecessors.store(task.predecessor_count, std::memory_order_relaxed);
+
+    // Every task job is spawned from the root job or from one of its predecessors, so the root job completes with the whole graph
+    current_run = new_job(
+        [this]
+        {
+            for (const TaskId root : roots)
+                new_job([this, root] { run_task(root); });
+        },
+        true);
+    return current_run;
+}
+
+void TaskGraph::wait()
+{
+    if (current_run)
+        current_run->wait();
+}
+
+bool TaskGraph::validate()
+{
+    roots.clear();
+    std::vector<uint32_t> remaining(tasks.size());
+    std::vector<TaskId>   ready;
+    for (TaskId i = 0; i < tasks.size(); ++i)
+    {
+        remaining[i] = tasks[i].predecessor_count;
+        if (remaining[i] == 0)
+        {
+            roots.emplace_back(i);
+            ready.emplace_back(i);
+        }
+    }
+
+    size_t visited = 0;
+    while (!ready.empty())
+    {
+        const TaskId task = ready.back();
+        ready.pop_back();
+        visited++;
+        for (const TaskId successor : tasks[task].successors)
+            if (--remaining[successor] == 0)
+                ready.emplace_back(successor);
+    }
+
+    if (visited != tasks.size())
+    {
+        for (TaskId i = 0; i < tasks.size(); ++i)
+            if (remaining[i] != 0)
+                LOG_ERROR("task graph contains a cycle involving task '%s'", tasks[i].name);
+        return false;
+    }
+    return true;
+}
+
+void TaskGraph::run_task(TaskId task_id)
+{
+    Task& task = tasks[task_id];
+    if (task.function)
+        task.function();
+
+    // Continuations : the last predecessor to complete pushes the successor
+    for (const TaskId successor : task.successors)
+    {
+        if (tasks[successor].remaining_predecessors.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            new_job([this, successor] { run_task(successor); });
+    }
+}
+
+} // namespace job_system
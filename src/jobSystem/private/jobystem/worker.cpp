@@ -1,155 +1,539 @@
 #include "jobSystem/worker.h"
 #include "jobSystem/job.h"
 
-#include <cpputils/logger.hpp>
-#include "types/semaphores.h"
+#include "fiber.h"
+#include "jobSystem/event_count.h"
+#include "jobSystem/job_trace.h"
 #include "statsRecorder.h"
+#include "types/cpu_relax.h"
+#include "types/semaphores.h"
+#include <algorithm>
+#include <cpputils/logger.hpp>
+#include <deque>
+#include <vector>
+
+namespace job_system
+{
+
+Worker* workers                 = nullptr;
+size_t  worker_count            = 0;
+size_t  background_worker_count = 0;
+
+CpuTopology topology;
+// Worker indices of each NUMA node, so thieves try their own node first
+std::vector<std::vector<uint32_t>> numa_node_workers;
+
+thread_local Worker* current_thread_worker = nullptr;
+
+// Jobs pushed from outside of the workers (one queue per priority) : pushes are serialized by the lock, workers steal from them
+TWorkStealingQueue<IJobTask> job_pools[JOB_PRIORITY_COUNT];
+std::mutex                   job_pool_push_lock;
+std::counting_semaphore<>    workers_create_semaphore(0);
+std::counting_semaphore<>    workers_release_semaphore(0);
+
+// Idle workers park here once their spin budget is exhausted. Reserved background workers have their own lane.
+EventCount           parked_workers;
+EventCount           parked_background_workers;
+std::atomic_uint32_t spin_budget   = Worker::DEFAULT_SPIN_BUDGET;
+std::atomic_uint64_t stat_wake_ups = 0;
+
+// Jobs waiting in any queue, per priority
+std::atomic_int64_t queued_jobs[JOB_PRIORITY_COUNT] = {};
+// Fiber mode : fibers whose wait is over, resumed by the first available worker
+std::unique_ptr<FiberPool> fiber_pool;
+std::deque<Fiber*>         ready_fibers;
+std::mutex                 ready_fibers_lock;
+std::atomic_int64_t        ready_fiber_count = 0;
+
+// Jobs pushed but not executed yet (queued or running)
+std::atomic_int64_t unfinished_jobs = 0;
+
+std::atomic_int64_t& queued_job_count(JobPriority priority)
+{
+    return queued_jobs[static_cast<size_t>(priority)];
+}
+
+void Worker::create_workers(int desired_worker_count, int desired_background_worker_count)
+{
+    create_workers(WorkerSettings{.worker_count = desired_worker_count, .background_worker_count = desired_background_worker_count});
+}
 
-namespace job_system {
+void Worker::create_workers(const WorkerSettings& settings)
+{
+    Logger::get().set_thread_identifier(get_log_thread_id);
 
-    uint8_t get_worker_id_internal()
+    if (workers)
+        LOG_FATAL("cannot add more workers");
+
+    topology = CpuTopology::detect();
+    LOG_INFO("cpu topology : %s", topology.to_string().c_str());
+
+    // Create one worker per CPU thread (or per physical core)
+    int desired_worker_count            = settings.worker_count;
+    int desired_background_worker_count = settings.background_worker_count;
+    if (desired_worker_count <= 0)
+        desired_worker_count = settings.pin_threads && !settings.use_smt_siblings ? static_cast<int>(topology.get_physical_core_count()) : static_cast<int>(std::thread::hardware_concurrency());
+    if (desired_worker_count <= 0)
+        desired_worker_count = 1;
+
+    if (desired_background_worker_count >= desired_worker_count)
     {
-        if (auto* worker = Worker::get())
-        {
-            return worker->get_worker_id();
-        }
-        return 255;
+        LOG_ERROR("cannot reserve %d background workers out of %d workers", desired_background_worker_count, desired_worker_count);
+        desired_background_worker_count = desired_worker_count - 1;
     }
-	
-    Worker *workers = nullptr;
-    size_t worker_count = 0;
+    if (desired_background_worker_count < 0)
+        desired_background_worker_count = 0;
+
+    LOG_INFO("create %d workers (%d reserved for background jobs) over %u CPU threads from thread %x", desired_worker_count, desired_background_worker_count, std::thread::hardware_concurrency(), std::this_thread::get_id());
+
+    // Both counts are validated : convert them once
+    const size_t new_worker_count            = static_cast<size_t>(desired_worker_count);
+    const size_t new_background_worker_count = static_cast<size_t>(desired_background_worker_count);
+
+    // Allocate workers memory (queues are cache line aligned)
+    workers = static_cast<Worker*>(::operator new(new_worker_count * sizeof(Worker), std::align_val_t(alignof(Worker))));
 
-    TObjectPool<IJobTask, 16384> job_pool;
-    std::counting_semaphore<> workers_create_semaphore(0);
-    std::counting_semaphore<> workers_release_semaphore(0);
-    std::counting_semaphore<> workers_destroy_semaphore(0);
-    std::binary_semaphore workers_complete_semaphore(0);
+    if (settings.use_fibers)
+    {
+        fiber_pool = std::make_unique<FiberPool>(settings.fiber_count, settings.fiber_stack_size, &Worker::fiber_main);
+        LOG_INFO("run jobs on %zu fibers of %zu KiB", settings.fiber_count, settings.fiber_stack_size / 1024);
+    }
 
-    std::condition_variable wake_up_worker_condition_variable;
+    std::vector<CpuTopology::LogicalCpu> worker_cpus;
+    if (settings.pin_threads)
+        worker_cpus = topology.select_worker_cpus(new_worker_count, settings.use_smt_siblings);
 
-    std::atomic_int jobs = 0;
+    // Create and release workers
+    numa_node_workers.assign(topology.get_numa_node_count(), {});
+    for (size_t i = 0; i < new_worker_count; ++i)
+    {
+        new (workers + i) Worker(static_cast<uint32_t>(i), i >= new_worker_count - new_background_worker_count, worker_cpus.empty() ? nullptr : &worker_cpus[i]);
+        numa_node_workers[workers[i].numa_node].emplace_back(static_cast<uint32_t>(i));
+    }
+    worker_count            = new_worker_count;
+    background_worker_count = new_background_worker_count;
 
-    void Worker::create_workers(int desired_worker_count) {
+    if (settings.pin_threads)
+        for (size_t i = 0; i < new_worker_count; ++i)
+            LOG_DEBUG("worker %zu pinned to cpu %d (NUMA node %u)", i, workers[i].pinned_cpu, workers[i].numa_node);
+    for (size_t i = 0; i < new_worker_count; ++i)
+        workers_release_semaphore.release();
+    for (size_t i = 0; i < new_worker_count; ++i)
+        workers_create_semaphore.acquire();
+}
 
-        Logger::get().set_thread_identifier(get_worker_id_internal);
-    	
-        if (workers) LOG_FATAL("cannot add more workers");
+Worker* Worker::get()
+{
+    return current_thread_worker;
+}
 
-        // Create one worker per CPU thread
-        if (desired_worker_count <= 0) desired_worker_count = static_cast<int>(std::thread::hardware_concurrency());
+uint8_t Worker::get_log_thread_id()
+{
+    // The logger tags lines with 8 bits : workers past 254 share the last tag
+    if (const Worker* worker = get())
+        return static_cast<uint8_t>(std::min(worker->get_worker_id(), static_cast<uint32_t>(UINT8_MAX - 1)));
+    return UINT8_MAX;
+}
 
-        LOG_INFO("create %d workers over %u CPU threads from thread %x", desired_worker_count, std::thread::hardware_concurrency(), std::this_thread::get_id());
-        
-        // Allocate workers memory
-        workers = static_cast<Worker *>(malloc(desired_worker_count * sizeof(Worker)));
+Worker* Worker::get_worker(size_t worker_id)
+{
+    return workers + worker_id;
+}
 
-        // Create and release workers
-        for (size_t i = 0; i < desired_worker_count; ++i) new(workers + i) Worker(static_cast<uint8_t>(i));
-        worker_count += desired_worker_count;
-        for (size_t i = 0; i < desired_worker_count; ++i) workers_release_semaphore.release();
-        for (size_t i = 0; i < desired_worker_count; ++i) workers_create_semaphore.acquire();
+void Worker::push_job(IJobTask* new_task)
+{
+    trace::record(trace::EventType::Enqueue, new_task);
+    unfinished_jobs.fetch_add(1, std::memory_order_relaxed);
+    queued_job_count(new_task->priority).fetch_add(1, std::memory_order_seq_cst);
+    new_task->add_reference();
+    const size_t queue_index = static_cast<size_t>(new_task->priority);
+    if (Worker* worker = get())
+    {
+        worker->local_queues[queue_index].push(new_task);
+    }
+    else
+    {
+        std::lock_guard lock(job_pool_push_lock);
+        job_pools[queue_index].push(new_task);
     }
+    wake_up_worker(new_task->priority);
+}
 
-    Worker* Worker::get() {
-        for (uint32_t i = 0; i < worker_count; ++i) {
-            if (workers[i]) {
-                return workers + i;
-            }
+void Worker::wait_job_completion()
+{
+    for (int64_t remaining = unfinished_jobs.load(); remaining > 0; remaining = unfinished_jobs.load())
+    {
+        unfinished_jobs.wait(remaining);
+    }
+}
+
+void Worker::destroy_workers()
+{
+    for (size_t i = 0; i < worker_count; ++i)
+        workers[i].run.store(false, std::memory_order_seq_cst);
+    parked_workers.notify_all();
+    parked_background_workers.notify_all();
+    for (size_t i = 0; i < worker_count; ++i)
+    {
+        workers[i].worker_thread.join();
+        workers[i].~Worker();
+    }
+    fiber_pool.reset();
+    LOG_INFO("no more job - destroyed workers");
+    ::operator delete(workers, std::align_val_t(alignof(Worker)));
+    workers                 = nullptr;
+    worker_count            = 0;
+    background_worker_count = 0;
+    numa_node_workers.clear();
+}
+
+size_t Worker::get_worker_count()
+{
+    return worker_count;
+}
+
+size_t Worker::get_background_worker_count()
+{
+    return background_worker_count;
+}
+
+bool Worker::uses_fibers()
+{
+    return fiber_pool != nullptr;
+}
+
+const CpuTopology& Worker::get_topology()
+{
+    return topology;
+}
+
+int64_t Worker::get_queued_job_count(JobPriority priority)
+{
+    return queued_job_count(priority).load(std::memory_order_relaxed);
+}
+
+void Worker::wake_up_worker(JobPriority priority)
+{
+    EventCount& lane = priority == JobPriority::Background && background_worker_count > 0 ? parked_background_workers : parked_workers;
+
+    // Only touches the futex when a worker is actually parked
+    if (lane.notify_one())
+        stat_wake_ups.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Worker::set_spin_budget(uint32_t iterations)
+{
+    spin_budget.store(iterations, std::memory_order_relaxed);
+}
+
+uint32_t Worker::get_spin_budget()
+{
+    return spin_budget.load(std::memory_order_relaxed);
+}
+
+Worker::ParkingStats Worker::get_parking_stats()
+{
+    ParkingStats total;
+    for (size_t i = 0; i < worker_count; ++i)
+    {
+        const ParkingStats worker_stats = workers[i].get_worker_parking_stats();
+        total.spins += worker_stats.spins;
+        total.parks += worker_stats.parks;
+    }
+    total.wake_ups = stat_wake_ups.load(std::memory_order_relaxed);
+    return total;
+}
+
+Worker::ParkingStats Worker::get_worker_parking_stats() const
+{
+    return {.spins = stat_spins.load(std::memory_order_relaxed), .parks = stat_parks.load(std::memory_order_relaxed)};
+}
+
+bool Worker::help_or_yield()
+{
+    if (Worker* worker = get())
+    {
+        if (worker->resume_ready_fiber())
+            return true;
+        if (IJobTask* task = worker->find_task())
+        {
+            worker->execute_task(task);
+            return true;
         }
-        return nullptr;
     }
+    std::this_thread::yield();
+    return false;
+}
+
+Worker::Worker(uint32_t worker_id, bool is_background_only, const CpuTopology::LogicalCpu* cpu)
+    : random_state(0x9E3779B97F4A7C15ull * (worker_id + 1)), id(worker_id), numa_node(cpu ? cpu->numa_node : 0), pinned_cpu(cpu ? static_cast<int32_t>(cpu->cpu_id) : -1),
+      background_only(is_background_only), worker_thread(&Worker::thread_main, worker_id)
+{
+}
 
-    Worker* Worker::get_worker(size_t worker_id)
+void Worker::thread_main(uint32_t worker_id)
+{
+    workers_release_semaphore.acquire();
+    current_thread_worker = get_worker(worker_id);
+    if (current_thread_worker->pinned_cpu >= 0 && !CpuTopology::pin_current_thread(static_cast<uint32_t>(current_thread_worker->pinned_cpu)))
+        LOG_WARNING("failed to pin worker %u to cpu %d", worker_id, current_thread_worker->pinned_cpu);
+    LOG_INFO("create worker on thread %x", std::this_thread::get_id());
+    workers_create_semaphore.release();
+    while (current_thread_worker->run)
     {
-        return workers + worker_id;
+        current_thread_worker->next_task();
     }
+    current_thread_worker = nullptr;
+}
 
-    void Worker::push_orphan_job(std::shared_ptr<IJobTask> newTask) {
-        job_pool.push(newTask);
-        wake_up_worker_condition_variable.notify_one();
+/**
+ * Execute next worker loop
+ */
+void Worker::next_task()
+{
+    // Suspended jobs first : they hold resources and were started earlier
+    if (resume_ready_fiber())
+        return;
+
+    if (IJobTask* found_job = find_task())
+    {
+        execute_task(found_job);
+    }
+    else
+    {
+        wait_for_task();
     }
+}
 
-    void Worker::wait_job_completion() {
-        while (!job_pool.is_empty() || jobs > 0) {
-            workers_complete_semaphore.acquire();
+/**
+ * Spin for a while (jobs usually come in bursts), then park until a job is pushed
+ */
+void Worker::wait_for_task()
+{
+    const uint32_t budget = spin_budget.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < budget; ++i)
+    {
+        // Give the CPU back from time to time in case workers outnumber hardware threads
+        if ((i & 63) == 63)
+            std::this_thread::yield();
+        else
+            CPU_RELAX();
+        if (has_runnable_jobs() || !run.load(std::memory_order_relaxed))
+        {
+            stat_spins.store(stat_spins.load(std::memory_order_relaxed) + i + 1, std::memory_order_relaxed);
+            return;
         }
     }
+    stat_spins.store(stat_spins.load(std::memory_order_relaxed) + budget, std::memory_order_relaxed);
+
+    // Recheck after registering as a waiter : a push either sees us in the eventcount, or we see its queued job
+    EventCount&           lane = background_only ? parked_background_workers : parked_workers;
+    const EventCount::Key key  = lane.prepare_wait();
+    if (has_runnable_jobs() || !run.load(std::memory_order_seq_cst))
+    {
+        lane.cancel_wait();
+        return;
+    }
+    stat_parks.store(stat_parks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    trace::record(trace::EventType::Park);
+    lane.commit_wait(key);
+    trace::record(trace::EventType::Unpark);
+}
 
-    void Worker::destroy_workers() {
-        for (int i = 0; i < worker_count; ++i) {
-            workers[i].run = false;
+void Worker::execute_task(IJobTask* task)
+{
+    // In fiber mode each top level job gets its own fiber, so it can be suspended while it waits
+    if (fiber_pool && !Fiber::current())
+    {
+        if (Fiber* fiber = fiber_pool->acquire())
+        {
+            fiber->task         = task;
+            fiber->current_task = task;
+            run_fiber(fiber);
+            return;
         }
-        wake_up_worker_condition_variable.notify_all();
-    	for (int i = 0; i < worker_count; ++i)
-    	{
-            workers_destroy_semaphore.acquire();
-    	}
-        LOG_INFO("no more job - destroyed workers");
-        free(workers);
     }
+    execute_task_inline(task);
+}
+
+void Worker::execute_task_inline(IJobTask* task)
+{
+    Fiber*    fiber         = Fiber::current();
+    IJobTask* previous_task = get()->current_task.exchange(task, std::memory_order_relaxed);
+    if (fiber)
+        fiber->current_task = task;
+    BEGIN_NAMED_RECORD(worker_execute_job);
+    ADD_NAMED_TIMEPOINT(worker_begin_job);
+    trace::record(trace::EventType::Start, task);
+    task->execute();
+    trace::record(trace::EventType::End, task);
+    ADD_NAMED_TIMEPOINT(worker_complete_job);
+    if (unfinished_jobs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        unfinished_jobs.notify_all();
+    // Don't reuse a worker pointer from before execute() : the fiber may have moved to another worker
+    get()->current_task.store(previous_task, std::memory_order_relaxed);
+    if (fiber)
+        fiber->current_task = previous_task;
+    task->release_reference();
+}
 
-    size_t Worker::get_worker_count() {
-        return worker_count;
+void Worker::fiber_main(Fiber* fiber)
+{
+    for (;;)
+    {
+        execute_task_inline(fiber->task);
+        fiber->state = Fiber::State::Finished;
+        Fiber::yield_to_thread();
     }
+}
 
-    void Worker::wake_up_worker()
+void Worker::run_fiber(Fiber* fiber)
+{
+    IJobTask* previous_task = current_task.exchange(fiber->current_task, std::memory_order_relaxed);
+    fiber->resume();
+    current_task.store(previous_task, std::memory_order_relaxed);
+
+    if (fiber->state == Fiber::State::Finished)
     {
-        wake_up_worker_condition_variable.notify_one();
+        fiber_pool->release(fiber);
+        return;
     }
 
-    Worker::Worker(const uint8_t worker_id)
-            : id(worker_id), worker_thread([]() {
-        workers_release_semaphore.acquire();
-              LOG_INFO("create worker on thread %x", std::this_thread::get_id());
-        workers_create_semaphore.release();
-        Worker *worker;
-        do {
-            if ((worker = get())) {
-                worker->next_task();
-            }
-            else
-                LOG_FATAL("failed to find worker on current thread");
-        } while (worker->run);
-        workers_destroy_semaphore.release();
-    }) {}
-
-	/**
-	 * Execute next worker loop
-	 */
-    void Worker::next_task() {
-        if (auto found_job = steal_or_get_task()) {
-            current_task = found_job;
-            BEGIN_NAMED_RECORD(worker_execute_job);
-            ++jobs;
-            ADD_NAMED_TIMEPOINT(worker_begin_job);
-            found_job->execute();
-            ADD_NAMED_TIMEPOINT(worker_complete_job);
-            --jobs;
-            workers_complete_semaphore.release();         
-            current_task = found_job->parent_task;
-        } else {
-        	// Wait next job order
-            std::unique_lock<std::mutex> WakeUpWorkerLock(WaitNewJobMutex);
-            wake_up_worker_condition_variable.wait(WakeUpWorkerLock);
-        }
+    // The fiber is off its stack now : it can safely be handed to other workers.
+    // Once registered it may be resumed right away and release the awaited job, so keep it alive meanwhile.
+    IJobTask* awaited_task = fiber->awaited_task;
+    awaited_task->add_reference();
+    if (fiber->state == Fiber::State::WaitingJob)
+        awaited_task->add_waiter(fiber);
+    else if (fiber->state == Fiber::State::WaitingChildren)
+        awaited_task->set_children_waiter(fiber);
+    else
+        LOG_FATAL("fiber yielded in an unexpected state");
+    awaited_task->release_reference();
+}
+
+void Worker::schedule_fiber(Fiber* fiber)
+{
+    {
+        std::lock_guard lock(ready_fibers_lock);
+        ready_fibers.emplace_back(fiber);
     }
+    ready_fiber_count.fetch_add(1, std::memory_order_seq_cst);
+    wake_up_worker(JobPriority::Normal);
+}
+
+bool Worker::resume_ready_fiber()
+{
+    // Fibers are only switched from the worker thread stack
+    if (ready_fiber_count.load(std::memory_order_relaxed) == 0 || Fiber::current())
+        return false;
 
-    std::shared_ptr<IJobTask> Worker::steal_or_get_task()
+    Fiber* fiber;
     {
-        if (auto task = steal_task()) return task;
-    	return job_pool.pop();
+        std::lock_guard lock(ready_fibers_lock);
+        if (ready_fibers.empty())
+            return false;
+        fiber = ready_fibers.front();
+        ready_fibers.pop_front();
     }
+    ready_fiber_count.fetch_sub(1, std::memory_order_relaxed);
+    run_fiber(fiber);
+    return true;
+}
+
+bool Worker::has_runnable_jobs() const
+{
+    if (ready_fiber_count.load(std::memory_order_seq_cst) > 0)
+        return true;
+    if (background_only)
+        return queued_job_count(JobPriority::Background).load(std::memory_order_seq_cst) > 0;
+
+    const int64_t critical = queued_job_count(JobPriority::Critical).load(std::memory_order_seq_cst);
+    if (critical > 0 || queued_job_count(JobPriority::Normal).load(std::memory_order_seq_cst) > 0)
+        return true;
+    return background_worker_count == 0 && queued_job_count(JobPriority::Background).load(std::memory_order_seq_cst) > 0;
+}
+
+IJobTask* Worker::find_task()
+{
+    if (background_only)
+        return find_task(JobPriority::Background);
+
+    if (IJobTask* task = find_task(JobPriority::Critical))
+        return task;
+    if (IJobTask* task = find_task(JobPriority::Normal))
+        return task;
+
+    // Background jobs never run while critical jobs are pending, and only on reserved workers if there are some
+    if (background_worker_count == 0 && queued_job_count(JobPriority::Critical).load(std::memory_order_relaxed) == 0)
+        return find_task(JobPriority::Background);
+    return nullptr;
+}
+
+IJobTask* Worker::find_task(JobPriority priority)
+{
+    std::atomic_int64_t& queued = queued_job_count(priority);
+    if (queued.load(std::memory_order_relaxed) == 0)
+        return nullptr;
 
-    std::shared_ptr<IJobTask> Worker::steal_task()
+    // Own queue first (LIFO), then jobs pushed from outside, then steal from other workers (FIFO)
+    const size_t queue_index = static_cast<size_t>(priority);
+    if (IJobTask* task = local_queues[queue_index].pop())
     {
-        for (size_t i = 0; i < worker_count; ++i)
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+    if (IJobTask* task = job_pools[queue_index].steal())
+    {
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+    return steal_task(priority);
+}
+
+IJobTask* Worker::steal_task(JobPriority priority)
+{
+    if (worker_count <= 1)
+        return nullptr;
+
+    // Start from a random victim (xorshift) so thieves don't all hammer the same queue
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    const size_t queue_index = static_cast<size_t>(priority);
+
+    // Victims of the same NUMA node first : their jobs' data is more likely to be in local memory and shared caches
+    const std::vector<uint32_t>& local_workers = numa_node_workers[numa_node];
+    if (local_workers.size() > 1 && local_workers.size() < worker_count)
+    {
+        const size_t first_local_victim = random_state % local_workers.size();
+        for (size_t i = 0; i < local_workers.size(); ++i)
         {
-            if (!workers[i].current_task) continue;
-            if (auto task = workers[i].current_task->steal_task())
+            Worker& victim = workers[local_workers[(first_local_victim + i) % local_workers.size()]];
+            if (&victim == this)
+                continue;
+            if (IJobTask* task = victim.local_queues[queue_index].steal())
             {
+                queued_job_count(priority).fetch_sub(1, std::memory_order_relaxed);
+                trace::record(trace::EventType::Steal, task);
                 return task;
             }
         }
-        return nullptr;
     }
+
+    const size_t first_victim = random_state % worker_count;
+    for (size_t i = 0; i < worker_count; ++i)
+    {
+        Worker& victim = workers[(first_victim + i) % worker_count];
+        if (&victim == this || (victim.numa_node == numa_node && local_workers.size() < worker_count))
+            continue;
+        if (IJobTask* task = victim.local_queues[queue_index].steal())
+        {
+            queued_job_count(priority).fetch_sub(1, std::memory_order_relaxed);
+            trace::record(trace::EventType::Steal, task);
+            return task;
+        }
+    }
+    return nullptr;
 }
+} // namespace job_system
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace job_system
+{
+
+/**
+ * Logical CPUs of the machine grouped by physical core, package and NUMA node.
+ * Read from /sys/devices/system/cpu on Linux. Other platforms (or a missing sysfs) fall back to one node of hardware_concurrency() independent cores.
+ */
+class CpuTopology final
+{
+  public:
+    struct LogicalCpu
+    {
+        // OS cpu index, used for pinning
+        uint32_t cpu_id = 0;
+        // Physical core index, unique over the whole machine
+        uint32_t core_id    = 0;
+        uint32_t package_id = 0;
+        uint32_t numa_node  = 0;
+        // False for the first hardware thread of each physical core
+        bool is_smt_sibling = false;
+    };
+
+    static CpuTopology detect();
+
+    /**
+     * Pick the cpus the workers will be pinned to : one hardware thread per physical core first, then SMT siblings if smt_siblings is set.
+     * Cpus are ordered per NUMA node so consecutive workers share a node.
+     */
+    [[nodiscard]] std::vector<LogicalCpu> select_worker_cpus(size_t worker_count, bool smt_siblings) const;
+
+    [[nodiscard]] const std::vector<LogicalCpu>& get_cpus() const
+    {
+        return cpus;
+    }
+    [[nodiscard]] uint32_t get_physical_core_count() const
+    {
+        return physical_core_count;
+    }
+    [[nodiscard]] uint32_t get_numa_node_count() const
+    {
+        return numa_node_count;
+    }
+    [[nodiscard]] uint32_t get_package_count() const
+    {
+        return package_count;
+    }
+
+    [[nodiscard]] std::string to_string() const;
+
+    /** Restrict the calling thread to the given cpu. Returns false if pinning is not supported or failed */
+    static bool pin_current_thread(uint32_t cpu_id);
+
+  private:
+    // Sort cpus and compute the counters
+    void finalize();
+
+    std::vector<LogicalCpu> cpus;
+    uint32_t                physical_core_count = 0;
+    uint32_t                numa_node_count     = 0;
+    uint32_t                package_count       = 0;
+};
+
+} // namespace job_system
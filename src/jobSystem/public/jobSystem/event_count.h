@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace job_system
+{
+
+/**
+ * Eventcount : lets threads sleep until a condition they check themselves becomes true, without a mutex.
+ * Sleeping relies on atomic wait / notify (futex on Linux), and notify() costs a single load when nobody sleeps.
+ *
+ * Waiter :
+ *     auto key = event.prepare_wait();
+ *     if (condition) event.cancel_wait(); else event.commit_wait(key);
+ * Notifier :
+ *     make condition true; event.notify_one();
+ */
+class EventCount final
+{
+  public:
+    using Key = uint32_t;
+
+    Key prepare_wait()
+    {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_seq_cst);
+    }
+
+    void cancel_wait()
+    {
+        waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void commit_wait(Key key)
+    {
+        while (epoch.load(std::memory_order_seq_cst) == key)
+            epoch.wait(key, std::memory_order_seq_cst);
+        waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    /** Return true if a sleeping thread was notified */
+    bool notify_one()
+    {
+        if (waiters.load(std::memory_order_seq_cst) == 0)
+            return false;
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        epoch.notify_one();
+        return true;
+    }
+
+    bool notify_all()
+    {
+        if (waiters.load(std::memory_order_seq_cst) == 0)
+            return false;
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        epoch.notify_all();
+        return true;
+    }
+
+    [[nodiscard]] int32_t get_waiter_count() const
+    {
+        return waiters.load(std::memory_order_relaxed);
+    }
+
+  private:
+    alignas(64) std::atomic_int32_t waiters = 0;
+    std::atomic_uint32_t            epoch   = 0;
+};
+
+} // namespace job_system
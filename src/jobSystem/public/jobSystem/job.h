@@ -1,138 +1,214 @@
 #pragma once
 
-#include <latch>
-#include <vector>
-#include <condition_variable>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
 
+#include "jobSystem/job_arena.h"
 #include "jobSystem/worker.h"
-#include "types/semaphores.h"
 
 namespace job_system
 {
 
-class worker_lock
+/**
+ * Intrusive node notified once the job it was added to completes (suspended fibers, coroutines...)
+ */
+class IJobWaiter
 {
   public:
-    explicit worker_lock(const std::ptrdiff_t current = 0) : val(current)
+    // Called once, possibly from add_waiter() itself when the job is already complete
+    virtual void on_job_complete() = 0;
+
+  protected:
+    ~IJobWaiter() = default;
+
+  private:
+    friend class IJobTask;
+    IJobWaiter* next_waiter = nullptr;
+};
+
+class IJobTask
+{
+  public:
+    virtual ~IJobTask() = default;
+
+    virtual void execute() = 0;
+
+    /** Name shown in traces. Generated from the job type, so it costs no storage */
+    [[nodiscard]] virtual const char* get_name() const
     {
+        return "job";
     }
 
-    void count_up()
+    /** Wait (and help executing other jobs) until every child of this job is complete */
+    void wait_children();
+
+    /** Wait until this job and all of its children are complete */
+    void wait();
+
+    static IJobTask* find_current_parent_task();
+    static int64_t   get_stat_total_job_count();
+    static int64_t   get_stat_awaiting_job_count();
+
+    [[nodiscard]] bool is_complete() const
     {
-        ++val;
+        return complete;
     }
 
-    void count_down()
+    // Must be called before the child is pushed, so the parent cannot complete in between
+    void register_child();
+
+    /** Notify the waiter once this job is complete. The waiter must stay alive until then */
+    void add_waiter(IJobWaiter* waiter);
+
+    void add_reference()
     {
-        --val;
-        try_release();
+        reference_count.fetch_add(1, std::memory_order_relaxed);
     }
 
-    void wait()
+    void release_reference()
     {
-        if (val == 0)
-            return;
-        std::unique_lock<std::mutex> lock(wait_m);
-        wait_cv.wait(lock);
+        if (reference_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            destroy();
     }
 
+    IJobTask*   parent_task = nullptr;
+    JobPriority priority    = JobPriority::Normal;
+
+  protected:
+    void inc_job_count();
+    void dec_awaiting_job_count();
+    void dec_total_job_count();
+
+    // Called once the job body and once per completed child. The last call completes the job and notifies its parent.
+    void finish();
+
+    std::atomic_bool complete = false;
+
   private:
-    void try_release()
-    {
-        if (val == 0)
-            wait_cv.notify_all();
-    }
+    template <class Job_T, typename... Args_T> friend Job_T* create_job(Args_T&&... arguments);
+    friend class Worker;
+
+    void destroy();
+
+    // Notified when only the job body is left (fiber mode : a job suspended in wait_children())
+    void set_children_waiter(IJobWaiter* waiter);
+    void notify_waiters();
+
+    std::atomic_int32_t reference_count = 0;
 
-    std::mutex              wait_m;
-    std::condition_variable wait_cv;
-    std::atomic_ptrdiff_t   val;
+    // Threads blocked in wait() : completion only notifies when there is someone to wake up
+    std::atomic_int32_t blocked_waiters = 0;
+
+    // The job body plus each unfinished child
+    std::atomic_int64_t unfinished = 1;
+
+    std::atomic<IJobWaiter*> waiters         = nullptr;
+    std::atomic<IJobWaiter*> children_waiter = nullptr;
+
+    // Arena page holding this job, or nullptr when it was too large and allocated on the heap
+    JobArena::Page* arena_page = nullptr;
 };
 
-class IJobTask
+/**
+ * Intrusive reference to a job
+ */
+class JobPtr final
 {
   public:
-    virtual void execute() = 0;
+    JobPtr() = default;
 
-    void push_child_task(const std::shared_ptr<IJobTask>& child)
+    JobPtr(IJobTask* in_task) : task(in_task)
     {
-        child_lock.count_up();
-        children_pool.push(child);
-        Worker::wake_up_worker();
+        if (task)
+            task->add_reference();
     }
 
-    std::shared_ptr<IJobTask> steal_task()
+    JobPtr(const JobPtr& other) : JobPtr(other.task)
     {
-        auto task = children_pool.pop();
-        return task;
     }
 
-    void wait_children()
+    JobPtr(JobPtr&& other) noexcept : task(std::exchange(other.task, nullptr))
     {
-        while (auto task = children_pool.pop())
-        {
-            Worker::get()->current_task = task;
-            task->execute();
-            Worker::get()->current_task = task->parent_task;
-        }
-        child_lock.wait();
     }
 
-    void wait()
+    ~JobPtr()
     {
-        while (auto task = children_pool.pop())
-        {
-            Worker::get()->current_task = task;
-            task->execute();
-            Worker::get()->current_task = task->parent_task;
-        }
-        completion_lock.wait();
-        child_lock.wait();
+        if (task)
+            task->release_reference();
     }
 
-    static std::shared_ptr<IJobTask> find_current_parent_task();
-    static int64_t                   get_stat_total_job_count();
-    static int64_t                   get_stat_awaiting_job_count();
+    JobPtr& operator=(JobPtr other) noexcept
+    {
+        std::swap(task, other.task);
+        return *this;
+    }
 
-    [[nodiscard]] bool is_complete() const
+    [[nodiscard]] IJobTask* get() const
     {
-        return complete;
+        return task;
     }
 
-    std::shared_ptr<IJobTask>   parent_task = nullptr;
-    TObjectPool<IJobTask, 16384> children_pool;
-    worker_lock                 child_lock;
-    std::latch                  completion_lock = std::latch(1);
+    IJobTask* operator->() const
+    {
+        return task;
+    }
 
-  protected:
-    void             inc_job_count();
-    void             dec_awaiting_job_count();
-    void             dec_total_job_count();
-    std::atomic_bool complete = false;
+    explicit operator bool() const
+    {
+        return task != nullptr;
+    }
+
+    bool operator==(const JobPtr& other) const = default;
+
+  private:
+    IJobTask* task = nullptr;
 };
 
 template <typename Lambda> class TJobTask : public IJobTask
 {
   public:
-    TJobTask(Lambda&& inFunc) : func(std::forward<Lambda>(inFunc))
+    template <typename Function_T> TJobTask(Function_T&& inFunc) : func(std::forward<Function_T>(inFunc))
     {
         inc_job_count();
     }
 
+    [[nodiscard]] const char* get_name() const override
+    {
+#if defined(_MSC_VER)
+        return __FUNCSIG__;
+#else
+        return __PRETTY_FUNCTION__;
+#endif
+    }
+
     virtual void execute()
     {
         dec_awaiting_job_count(); // stats
         func();                   // execute task
-        completion_lock.count_down();
-        dec_total_job_count(); // stats
-
-        wait();
-
-        complete = true;
-        if (parent_task)
-            parent_task->child_lock.count_down();
+        dec_total_job_count();    // stats
+        finish();
     }
 
   private:
     Lambda func;
 };
+
+/**
+ * Construct a job in the calling thread's arena (lambda captures are stored inline), or on the heap if it is too large.
+ */
+template <class Job_T, typename... Args_T> Job_T* create_job(Args_T&&... arguments)
+{
+    static_assert(alignof(Job_T) <= JobArena::ALIGNMENT, "over aligned jobs are not supported");
+
+    JobArena::Page* page   = nullptr;
+    void*           memory = JobArena::get().allocate(sizeof(Job_T), page);
+    if (!memory)
+        memory = ::operator new(sizeof(Job_T), std::align_val_t(JobArena::ALIGNMENT));
+
+    Job_T* job      = new (memory) Job_T(std::forward<Args_T>(arguments)...);
+    job->arena_page = page;
+    return job;
+}
 } // namespace job_system
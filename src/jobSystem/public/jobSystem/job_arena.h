@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace job_system
+{
+
+/**
+ * Per-thread bump allocator for jobs.
+ * Memory is cut in fixed size pages counting their live allocations. A page is rewound once all the jobs it holds were released :
+ * at the beginning of each frame (see begin_frame()) or when the current page is full. Releasing a job from any thread only decrements a counter,
+ * so steady state job submission never reaches the heap.
+ * Arenas are recycled when their thread exits, and their memory is never returned to the system while jobs may still point to it.
+ */
+class JobArena final
+{
+  public:
+    static constexpr size_t PAGE_SIZE      = 64 * 1024;
+    static constexpr size_t ALIGNMENT      = 64;
+    static constexpr size_t MAX_ALLOCATION = PAGE_SIZE / 4;
+
+    struct Page
+    {
+        std::atomic_int32_t live_allocations = 0;
+        size_t              offset           = 0;
+    };
+
+    /** Arena of the calling thread */
+    static JobArena& get();
+
+    /** Start a new frame : each arena rewinds to its first drained page on its next allocation */
+    static void begin_frame();
+
+    /** Allocate memory for a job. Returns nullptr if size exceeds MAX_ALLOCATION. */
+    void* allocate(size_t size, Page*& out_page);
+
+    /** Release one allocation. Can be called from any thread. */
+    static void free(Page* page)
+    {
+        page->live_allocations.fetch_sub(1, std::memory_order_release);
+    }
+
+    [[nodiscard]] static size_t get_total_page_count();
+
+    JobArena() = default;
+    ~JobArena();
+    JobArena(const JobArena&) = delete;
+    JobArena& operator=(const JobArena&) = delete;
+
+  private:
+    void  rewind();
+    Page* next_page();
+
+    std::vector<Page*> pages;
+    size_t             current_page_index = 0;
+    Page*              current_page       = nullptr;
+    uint64_t           frame_index        = 0;
+};
+
+} // namespace job_system
@@ -2,37 +2,48 @@
 
 #include "job.h"
 #include "worker.h"
-#include <memory>
 
 namespace job_system
 {
 
-/** Create min new job */
-template <class Lambda> std::shared_ptr<TJobTask<Lambda>> new_job(Lambda&& funcLambda, bool is_orphan = false)
+/** Create a new job with the given priority */
+template <class Lambda> JobPtr new_job(Lambda&& funcLambda, JobPriority priority, bool is_orphan = false)
 {
-    auto job = std::make_shared<TJobTask<Lambda>>((std::forward<Lambda>(funcLambda)));
+    JobPtr job    = create_job<TJobTask<std::decay_t<Lambda>>>(std::forward<Lambda>(funcLambda));
+    job->priority = priority;
 
-    if (is_orphan)
-        Worker::push_orphan_job(job);
-    else
+    if (!is_orphan)
     {
-        if (auto task = IJobTask::find_current_parent_task())
+        if (IJobTask* task = IJobTask::find_current_parent_task())
         {
+            task->add_reference();
             job->parent_task = task;
-            task->push_child_task(job);
+            task->register_child();
         }
-        else
-            Worker::push_orphan_job(job);
     }
+    Worker::push_job(job.get());
 
     return job;
 }
 
+/** Create min new job : it inherits the priority of the job it is created from */
+template <class Lambda> JobPtr new_job(Lambda&& funcLambda, bool is_orphan = false)
+{
+    const IJobTask* current_task = IJobTask::find_current_parent_task();
+    return new_job(std::forward<Lambda>(funcLambda), current_task ? current_task->priority : JobPriority::Normal, is_orphan);
+}
+
+/** Start a new frame : job memory released during the previous frames is recycled */
+inline void begin_frame()
+{
+    JobArena::begin_frame();
+}
+
 inline void wait_children()
 {
     if (auto* worker = Worker::get())
     {
-        if (auto task = worker->get_current_task())
+        if (IJobTask* task = worker->get_current_task())
         {
             task->wait_children();
         }
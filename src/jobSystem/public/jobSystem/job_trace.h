@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+
+namespace job_system
+{
+class IJobTask;
+
+/**
+ * Timeline of the job system : each thread records events in its own preallocated ring buffer (no lock, no allocation once the buffer exists).
+ * When a buffer is full, the oldest events are overwritten.
+ */
+namespace trace
+{
+enum class EventType : uint8_t
+{
+    Enqueue, // A job was pushed
+    Start,   // A worker started executing a job
+    End,     // A worker completed a job body
+    Steal,   // A worker took a job from another worker's queue
+    Park,    // A worker went to sleep
+    Unpark,  // A worker woke up
+};
+
+struct Event
+{
+    uint64_t        timestamp; // Nanoseconds, steady clock
+    const IJobTask* job;
+    const IJobTask* parent;
+    const char*     name;
+    EventType       type;
+};
+
+// Events kept per thread
+inline constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+namespace internal
+{
+inline std::atomic_bool enabled = false;
+
+void record_event(EventType type, const IJobTask* job);
+} // namespace internal
+
+/** Start recording. Previously recorded events are kept */
+void start();
+void stop();
+void clear();
+
+[[nodiscard]] inline bool is_enabled()
+{
+    return internal::enabled.load(std::memory_order_relaxed);
+}
+
+/** Costs a single relaxed load when tracing is disabled */
+inline void record(EventType type, const IJobTask* job = nullptr)
+{
+    if (is_enabled())
+        internal::record_event(type, job);
+}
+
+/**
+ * Write the recorded events as Chrome trace JSON (chrome://tracing, ui.perfetto.dev) : one track per thread, one slice per job execution
+ * with its queueing latency, enqueue -> start flow arrows, steal markers and parked (idle) spans.
+ * Stop tracing first to get a consistent capture.
+ */
+bool export_chrome_trace(const std::filesystem::path& path);
+
+} // namespace trace
+} // namespace job_system
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "job_system.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace job_system
+{
+
+namespace internal
+{
+/**
+ * Lazy binary splitting : a range is only split in two when the current worker has nothing left in its own queue for idle workers to steal.
+ * Loops are therefore split just enough to feed every worker, without allocating one job per element or per fixed size chunk.
+ */
+inline bool should_split_range()
+{
+    const Worker* worker = Worker::get();
+    return worker && Worker::get_worker_count() > 1 && !worker->has_local_jobs();
+}
+
+template <typename Index_T> Index_T default_grain(Index_T begin, Index_T end)
+{
+    // Aim for about 8 chunks per worker when the caller doesn't know better
+    const Index_T chunk_count = static_cast<Index_T>(std::max<size_t>(Worker::get_worker_count(), 1) * 8);
+    return std::max<Index_T>((end - begin) / chunk_count, 1);
+}
+
+template <typename Index_T, typename Lambda> void parallel_for_range(Index_T begin, Index_T end, const Index_T grain, const Lambda& function)
+{
+    while (begin < end)
+    {
+        if (end - begin > grain && should_split_range())
+        {
+            // Give the upper half away, keep processing the lower half
+            const Index_T middle = begin + (end - begin) / 2;
+            new_job([middle, end, grain, &function] { parallel_for_range(middle, end, grain, function); });
+            end = middle;
+            continue;
+        }
+
+        const Index_T chunk_end = std::min<Index_T>(begin + grain, end);
+        for (Index_T i = begin; i < chunk_end; ++i)
+            function(i);
+        begin = chunk_end;
+    }
+}
+
+template <typename Index_T, typename Value_T, typename Lambda, typename Reduce>
+Value_T parallel_reduce_range(Index_T begin, Index_T end, const Index_T grain, const Value_T& identity, const Lambda& function, const Reduce& reduce)
+{
+    Value_T result = identity;
+    while (begin < end)
+    {
+        if (end - begin > grain && should_split_range())
+        {
+            // Upper half is reduced by another job, then joined in order so reduce only needs to be associative
+            const Index_T middle      = begin + (end - begin) / 2;
+            Value_T       upper_value = identity;
+            auto          upper_job   = new_job([middle, end, grain, &identity, &function, &reduce, &upper_value] { upper_value = parallel_reduce_range(middle, end, grain, identity, function, reduce); });
+            result                    = reduce(result, parallel_reduce_range(begin, middle, grain, identity, function, reduce));
+            upper_job->wait();
+            return reduce(result, upper_value);
+        }
+
+        const Index_T chunk_end = std::min<Index_T>(begin + grain, end);
+        for (Index_T i = begin; i < chunk_end; ++i)
+            result = reduce(result, function(i));
+        begin = chunk_end;
+    }
+    return result;
+}
+} // namespace internal
+
+/**
+ * Call function(i) for each i in [begin, end) across the workers and return once every call completed.
+ * Ranges smaller than grain are never split. A grain of 0 picks one from the worker count.
+ */
+template <typename Index_T, typename Lambda> void parallel_for(Index_T begin, Index_T end, Index_T grain, Lambda&& function)
+{
+    static_assert(std::is_integral_v<Index_T>, "parallel_for expects an integral range");
+    if (begin >= end)
+        return;
+    if (grain == 0)
+        grain = internal::default_grain(begin, end);
+
+    if (Worker::get_worker_count() == 0)
+    {
+        for (Index_T i = begin; i < end; ++i)
+            function(i);
+        return;
+    }
+
+    // A dedicated root job lets the caller wait for this loop only
+    new_job([begin, end, grain, &function] { internal::parallel_for_range(begin, end, grain, function); })->wait();
+}
+
+/**
+ * Return reduce(...reduce(reduce(identity, function(begin)), function(begin + 1))..., function(end - 1)) computed across the workers.
+ * reduce must be associative, identity must be its neutral element.
+ */
+template <typename Index_T, typename Value_T, typename Lambda, typename Reduce>
+Value_T parallel_reduce(Index_T begin, Index_T end, Index_T grain, const Value_T& identity, Lambda&& function, Reduce&& reduce)
+{
+    static_assert(std::is_integral_v<Index_T>, "parallel_reduce expects an integral range");
+    if (begin >= end)
+        return identity;
+    if (grain == 0)
+        grain = internal::default_grain(begin, end);
+
+    if (Worker::get() || Worker::get_worker_count() == 0)
+        return internal::parallel_reduce_range(begin, end, grain, identity, function, reduce);
+
+    Value_T result = identity;
+    new_job([begin, end, grain, &identity, &function, &reduce, &result] { result = internal::parallel_reduce_range(begin, end, grain, identity, function, reduce); })->wait();
+    return result;
+}
+
+} // namespace job_system
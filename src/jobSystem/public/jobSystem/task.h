@@ -0,0 +1,365 @@
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "jobSystem/job_system.h"
+
+namespace job_system
+{
+template <typename Value_T = void> class Task;
+
+namespace internal
+{
+class CoroutineJob;
+
+inline JobPriority get_current_priority()
+{
+    const IJobTask* current_task = IJobTask::find_current_parent_task();
+    return current_task ? current_task->priority : JobPriority::Normal;
+}
+
+/** Resume the coroutine from a new job */
+inline void resume_on_worker(std::coroutine_handle<> handle, JobPriority priority)
+{
+    // Orphan : the job currently running (often the one that just completed) must not become its parent
+    new_job([handle] { handle.resume(); }, priority, true);
+}
+
+class TaskPromiseBase
+{
+  public:
+    struct FinalAwaiter
+    {
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        template <typename Promise_T> std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise_T> handle) noexcept
+        {
+            // Symmetric transfer to the awaiting coroutine, so long co_await chains don't grow the stack
+            TaskPromiseBase& promise = handle.promise();
+            if (promise.continuation)
+                return promise.continuation;
+            if (promise.launch_job)
+                promise.complete_launch_job();
+            return std::noop_coroutine();
+        }
+
+        void await_resume() noexcept
+        {
+        }
+    };
+
+    std::suspend_always initial_suspend() noexcept
+    {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() noexcept
+    {
+        return {};
+    }
+
+    void unhandled_exception()
+    {
+        exception = std::current_exception();
+    }
+
+    std::coroutine_handle<> continuation;
+    CoroutineJob*           launch_job = nullptr;
+    std::exception_ptr      exception;
+
+  private:
+    void complete_launch_job();
+};
+
+template <typename Value_T> class TaskPromise final : public TaskPromiseBase
+{
+  public:
+    Task<Value_T> get_return_object();
+
+    template <typename Result_T> void return_value(Result_T&& result)
+    {
+        value.emplace(std::forward<Result_T>(result));
+    }
+
+    Value_T take_result()
+    {
+        if (exception)
+            std::rethrow_exception(exception);
+        return std::move(*value);
+    }
+
+  private:
+    std::optional<Value_T> value;
+};
+
+template <> class TaskPromise<void> final : public TaskPromiseBase
+{
+  public:
+    Task<void> get_return_object();
+
+    void return_void()
+    {
+    }
+
+    void take_result()
+    {
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+};
+
+/**
+ * Job running a launched coroutine : it only completes once the coroutine returned, whatever the number of suspensions
+ */
+class CoroutineJob final : public IJobTask
+{
+  public:
+    CoroutineJob(std::coroutine_handle<TaskPromise<void>> in_handle) : handle(in_handle)
+    {
+        // The coroutine holds one pending "child" until its final suspension
+        register_child();
+        handle.promise().launch_job = this;
+    }
+
+    ~CoroutineJob() override
+    {
+        handle.destroy();
+    }
+
+    [[nodiscard]] const char* get_name() const override
+    {
+        return "coroutine";
+    }
+
+    void execute() override
+    {
+        handle.resume();
+        finish();
+    }
+
+    void complete_coroutine()
+    {
+        if (handle.promise().exception)
+            std::terminate(); // Nobody can observe the exception of a launched task
+        // Once complete, the waiting thread may drop its reference : keep the job (and the coroutine frame) alive until finish() returns
+        add_reference();
+        finish();
+        release_reference();
+    }
+
+  private:
+    std::coroutine_handle<TaskPromise<void>> handle;
+};
+
+inline void TaskPromiseBase::complete_launch_job()
+{
+    launch_job->complete_coroutine();
+}
+
+} // namespace internal
+
+/**
+ * Lazy coroutine executed on the job system workers. It starts when it is awaited (co_await) or launched (launch()).
+ * Awaiting a job, a file read or a blocking call suspends the coroutine without blocking its worker.
+ */
+template <typename Value_T> class [[nodiscard]] Task final
+{
+  public:
+    using promise_type = internal::TaskPromise<Value_T>;
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr))
+    {
+    }
+
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    [[nodiscard]] bool is_ready() const
+    {
+        return !handle || handle.done();
+    }
+
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept
+            {
+                return handle.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+            {
+                handle.promise().continuation = caller;
+                return handle;
+            }
+
+            Value_T await_resume()
+            {
+                return handle.promise().take_result();
+            }
+        };
+        return Awaiter{handle};
+    }
+
+    /** Give up the ownership of the coroutine frame */
+    std::coroutine_handle<promise_type> release()
+    {
+        return std::exchange(handle, nullptr);
+    }
+
+  private:
+    friend class internal::TaskPromise<Value_T>;
+
+    explicit Task(std::coroutine_handle<promise_type> in_handle) : handle(in_handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+namespace internal
+{
+template <typename Value_T> Task<Value_T> TaskPromise<Value_T>::get_return_object()
+{
+    return Task<Value_T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object()
+{
+    return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+} // namespace internal
+
+/**
+ * Start the coroutine in a new job. The returned job completes when the coroutine returns : it can be waited for from regular code.
+ */
+inline JobPtr launch(Task<void>&& task, JobPriority priority = JobPriority::Normal)
+{
+    JobPtr job    = create_job<internal::CoroutineJob>(task.release());
+    job->priority = priority;
+    Worker::push_job(job.get());
+    return job;
+}
+
+/** Block the calling thread until the task completed, and return its result. Must not be called from a worker */
+template <typename Value_T> Value_T sync_wait(Task<Value_T>&& task)
+{
+    if constexpr (std::is_void_v<Value_T>)
+    {
+        launch(std::move(task))->wait();
+    }
+    else
+    {
+        std::optional<Value_T> result;
+        launch([](Task<Value_T> awaited, std::optional<Value_T>& output) -> Task<void> { output.emplace(co_await std::move(awaited)); }(std::move(task), result))->wait();
+        return std::move(*result);
+    }
+}
+
+/** co_await job : suspend until the job and its children completed */
+inline auto operator co_await(JobPtr job) noexcept
+{
+    struct Awaiter final : IJobWaiter
+    {
+        explicit Awaiter(JobPtr in_job) : job(std::move(in_job))
+        {
+        }
+
+        JobPtr                  job;
+        std::coroutine_handle<> handle;
+        JobPriority             priority = JobPriority::Normal;
+
+        bool await_ready() const noexcept
+        {
+            return !job || job->is_complete();
+        }
+
+        void await_suspend(std::coroutine_handle<> caller) noexcept
+        {
+            handle   = caller;
+            priority = internal::get_current_priority();
+            // The awaiter lives in the coroutine frame, which can be resumed and destroyed on another worker before add_waiter() returns
+            const JobPtr awaited_job = job;
+            awaited_job->add_waiter(this);
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+
+        void on_job_complete() override
+        {
+            internal::resume_on_worker(handle, priority);
+        }
+    };
+    return Awaiter(std::move(job));
+}
+
+/** co_await schedule_on(priority) : continue the coroutine in a new job of the given priority */
+inline auto schedule_on(JobPriority priority) noexcept
+{
+    struct Awaiter
+    {
+        JobPriority priority;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> caller) const
+        {
+            internal::resume_on_worker(caller, priority);
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+    return Awaiter{priority};
+}
+
+/**
+ * Run a blocking function (I/O, GPU fence wait...) on a background job, then continue with the priority the coroutine had before.
+ * With reserved background workers, the blocking call never holds a worker running frame work.
+ */
+template <typename Lambda> Task<std::invoke_result_t<Lambda>> blocking_call(Lambda function)
+{
+    const JobPriority caller_priority = internal::get_current_priority();
+    co_await schedule_on(JobPriority::Background);
+    if constexpr (std::is_void_v<std::invoke_result_t<Lambda>>)
+    {
+        function();
+        co_await schedule_on(caller_priority);
+    }
+    else
+    {
+        auto result = function();
+        co_await schedule_on(caller_priority);
+        co_return result;
+    }
+}
+
+/** Read a whole file from a background job. Returns an empty vector if the file cannot be read */
+Task<std::vector<uint8_t>> read_file_async(std::filesystem::path path);
+
+} // namespace job_system
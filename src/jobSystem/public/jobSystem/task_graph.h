@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+#include "jobSystem/job.h"
+
+namespace job_system
+{
+
+/**
+ * Dependency graph of tasks, built once and submitted as many times as needed (typically once per frame).
+ * Each submission resets the dependency counters. A task is pushed as a job by the last of its predecessors to complete,
+ * so no worker ever blocks waiting for a dependency.
+ */
+class TaskGraph final
+{
+  public:
+    using TaskId = size_t;
+
+    TaskGraph() = default;
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+    ~TaskGraph();
+
+    /** Add a task that will only start once every predecessor completed */
+    TaskId add_task(const char* name, std::function<void()> task, std::initializer_list<TaskId> predecessors = {});
+
+    /** task will only start after predecessor completed */
+    void add_dependency(TaskId task, TaskId predecessor);
+
+    /** Remove every task */
+    void clear();
+
+    /**
+     * Start a new run of the graph. The returned job completes with the last task.
+     * Returns an empty JobPtr if the graph contains a cycle or if the previous run is not complete yet.
+     */
+    JobPtr submit();
+
+    /** Wait for the last submission to complete */
+    void wait();
+
+    [[nodiscard]] bool is_running() const
+    {
+        return current_run && !current_run->is_complete();
+    }
+
+    [[nodiscard]] size_t get_task_count() const
+    {
+        return tasks.size();
+    }
+
+    [[nodiscard]] const char* get_task_name(TaskId task) const
+    {
+        return tasks[task].name;
+    }
+
+  private:
+    struct Task
+    {
+        const char*           name;
+        std::function<void()> function;
+        std::vector<TaskId>   successors;
+        uint32_t              predecessor_count = 0;
+        std::atomic_uint32_t  remaining_predecessors = 0;
+    };
+
+    // Sort roots and detect cycles (Kahn's algorithm)
+    bool validate();
+    void run_task(TaskId task_id);
+
+    std::deque<Task>    tasks;
+    std::vector<TaskId> roots;
+    bool                is_dirty = true;
+    bool                is_valid = false;
+    JobPtr              current_run;
+};
+
+} // namespace job_system
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace job_system
+{
+
+/**
+ * Lock-free Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli - "Correct and Efficient Work-Stealing for Weak Memory Models").
+ * The owner thread pushes and pops at the bottom (LIFO), any other thread can steal from the top (FIFO).
+ * The storage grows when full. Replaced buffers are retired and only released with the queue, since a thief may still be reading them.
+ */
+template <typename Object_T> class TWorkStealingQueue final
+{
+  public:
+    explicit TWorkStealingQueue(int64_t initial_capacity = 1024)
+    {
+        int64_t capacity = 1;
+        while (capacity < initial_capacity)
+            capacity <<= 1;
+        retired_buffers.emplace_back(std::make_unique<Buffer>(capacity));
+        buffer.store(retired_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    TWorkStealingQueue(const TWorkStealingQueue&) = delete;
+    TWorkStealingQueue& operator=(const TWorkStealingQueue&) = delete;
+
+    /** Owner only : push an object at the bottom of the queue */
+    void push(Object_T* object)
+    {
+        const int64_t b   = bottom.load(std::memory_order_relaxed);
+        const int64_t t   = top.load(std::memory_order_acquire);
+        Buffer*       buf = buffer.load(std::memory_order_relaxed);
+        if (b - t > buf->capacity - 1)
+        {
+            buf = grow(buf, b, t);
+        }
+        buf->put(b, object);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /** Owner only : pop the last pushed object, or nullptr if the queue is empty */
+    Object_T* pop()
+    {
+        const int64_t b   = bottom.load(std::memory_order_relaxed) - 1;
+        Buffer*       buf = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // Queue was empty
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Object_T* object = buf->get(b);
+        if (t == b)
+        {
+            // Last item : race against thieves
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                object = nullptr;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return object;
+    }
+
+    /** Any thread : steal the oldest object, or nullptr if the queue is empty or if another thread won the race */
+    Object_T* steal()
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+            return nullptr;
+
+        Object_T* object = buffer.load(std::memory_order_acquire)->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return object;
+    }
+
+    /** Approximate item count, only reliable from the owner thread */
+    [[nodiscard]] int64_t size() const
+    {
+        const int64_t b = bottom.load(std::memory_order_relaxed);
+        const int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+    [[nodiscard]] bool is_empty() const
+    {
+        return size() == 0;
+    }
+
+  private:
+    struct Buffer
+    {
+        explicit Buffer(int64_t in_capacity) : capacity(in_capacity), mask(in_capacity - 1), data(std::make_unique<std::atomic<Object_T*>[]>(in_capacity))
+        {
+        }
+
+        void put(int64_t index, Object_T* object)
+        {
+            data[index & mask].store(object, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] Object_T* get(int64_t index) const
+        {
+            return data[index & mask].load(std::memory_order_relaxed);
+        }
+
+        const int64_t                            capacity;
+        const int64_t                            mask;
+        std::unique_ptr<std::atomic<Object_T*>[]> data;
+    };
+
+    Buffer* grow(Buffer* old_buffer, int64_t b, int64_t t)
+    {
+        retired_buffers.emplace_back(std::make_unique<Buffer>(old_buffer->capacity * 2));
+        Buffer* new_buffer = retired_buffers.back().get();
+        for (int64_t i = t; i < b; ++i)
+            new_buffer->put(i, old_buffer->get(i));
+        buffer.store(new_buffer, std::memory_order_release);
+        return new_buffer;
+    }
+
+    alignas(64) std::atomic_int64_t top    = 0;
+    alignas(64) std::atomic_int64_t bottom = 0;
+    alignas(64) std::atomic<Buffer*> buffer = nullptr;
+
+    // Owner only : every buffer ever allocated by this queue (including the current one)
+    std::vector<std::unique_ptr<Buffer>> retired_buffers;
+};
+
+} // namespace job_system
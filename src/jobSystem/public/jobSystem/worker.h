@@ -1,70 +1,176 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <thread>
 
-#include "types/objectPool.h"
+#include "jobSystem/cpu_topology.h"
+#include "jobSystem/work_stealing_queue.h"
 
 #define MEMORY_BARRIER() std::atomic_thread_fence(std::memory_order_seq_cst)
 
 namespace job_system
 {
 class IJobTask;
+class Fiber;
+
+enum class JobPriority : uint8_t
+{
+    Critical,   // Per-frame latency critical work (culling, render preparation...)
+    Normal,     // Default
+    Background, // Streaming / import work : never picked while critical jobs are pending
+    Count
+};
+
+constexpr size_t JOB_PRIORITY_COUNT = static_cast<size_t>(JobPriority::Count);
+
+struct WorkerSettings
+{
+    // One worker per CPU thread if <= 0 (per physical core when pinning without SMT siblings)
+    int worker_count = -1;
+    // The last workers are reserved for background jobs : they run nothing else, and background jobs only run on them
+    int background_worker_count = 0;
+    // Pin each worker to its own cpu, grouped per NUMA node. Stealing then prefers victims of the same node.
+    bool pin_threads = false;
+    // When pinning, also place workers on the SMT siblings of the physical cores
+    bool use_smt_siblings = false;
+    // Run jobs on fibers : a job waiting for another one is suspended and its worker picks up other work meanwhile
+    bool use_fibers = false;
+    // Fibers and their stacks are allocated up front. Once they are all in use, jobs run (and wait) on the worker thread stack.
+    size_t fiber_count      = 128;
+    size_t fiber_stack_size = 256 * 1024;
+};
 
 class Worker final
 {
   public:
-    static void    create_workers(int worker_count = -1);
+    // Empty polls of the queues before an idle worker parks
+    static constexpr uint32_t DEFAULT_SPIN_BUDGET = 2048;
+
+    struct ParkingStats
+    {
+        uint64_t spins    = 0; // Empty polls while waiting for a job
+        uint64_t parks    = 0; // Times a worker went to sleep
+        uint64_t wake_ups = 0; // Parked workers notified by a push
+    };
+
+    static void    create_workers(const WorkerSettings& settings);
+    static void    create_workers(int worker_count = -1, int background_worker_count = 0);
     static Worker* get();
     static Worker* get_worker(size_t worker_id);
+    /** Tag of the calling thread in the logs : its worker id clamped to 8 bits, or UINT8_MAX outside of the workers */
+    static uint8_t get_log_thread_id();
 
-    static void push_orphan_job(std::shared_ptr<IJobTask> newTask);
+    /** Push a job on the current worker's queue, or on the shared injection queue when called from outside of the workers */
+    static void push_job(IJobTask* new_task);
     static void wait_job_completion();
     static void destroy_workers();
 
+    /** Execute one pending job on the calling worker if any can be found, else yield. Used to keep the worker busy while waiting */
+    static bool help_or_yield();
+
     [[nodiscard]] static size_t get_worker_count();
 
     [[nodiscard]] std::thread::id get_thread() const
     {
         return worker_thread.get_id();
     }
-    [[nodiscard]] uint8_t get_worker_id() const
+    [[nodiscard]] uint32_t get_worker_id() const
     {
         return id;
     }
-    [[nodiscard]] std::shared_ptr<IJobTask> get_current_task() const
+    [[nodiscard]] uint32_t get_numa_node() const
     {
-        return current_task;
+        return numa_node;
     }
-
-    static void wake_up_worker();
-
-    [[nodiscard]] bool is_busy() const
+    /** Cpu this worker is pinned to, or -1 */
+    [[nodiscard]] int32_t get_pinned_cpu() const
+    {
+        return pinned_cpu;
+    }
+    [[nodiscard]] IJobTask* get_current_task() const
     {
-        return current_task != nullptr;
+        return current_task.load(std::memory_order_relaxed);
     }
 
-    std::shared_ptr<IJobTask> current_task = nullptr;
+    /** Wake up a parked worker able to execute jobs of the given priority */
+    static void wake_up_worker(JobPriority priority = JobPriority::Normal);
 
-  private:
-    Worker(const uint8_t worker_id);
+    /** Number of polls an idle worker spins before parking. 0 parks immediately */
+    static void     set_spin_budget(uint32_t iterations);
+    static uint32_t get_spin_budget();
 
-    void next_task();
+    /** Parking counters accumulated over every worker */
+    [[nodiscard]] static ParkingStats get_parking_stats();
+    [[nodiscard]] ParkingStats        get_worker_parking_stats() const;
+
+    [[nodiscard]] bool is_busy() const
+    {
+        return get_current_task() != nullptr;
+    }
 
-    explicit operator bool() const
+    /** When false, other workers have nothing left to steal from this one */
+    [[nodiscard]] bool has_local_jobs() const
     {
-        return std::this_thread::get_id() == worker_thread.get_id();
+        for (const auto& queue : local_queues)
+            if (!queue.is_empty())
+                return true;
+        return false;
     }
-    [[nodiscard]] std::thread::id get_thread_id() const
+
+    [[nodiscard]] bool is_background_worker() const
     {
-        return worker_thread.get_id();
+        return background_only;
     }
 
-    [[nodiscard]] static std::shared_ptr<IJobTask> steal_or_get_task();
-    [[nodiscard]] static std::shared_ptr<IJobTask> steal_task();
+    [[nodiscard]] static size_t get_background_worker_count();
 
-    const std::thread worker_thread;
-    std::mutex        WaitNewJobMutex;
-    bool              run = true;
-    uint8_t           id;
+    /** True when jobs run on fibers */
+    [[nodiscard]] static bool uses_fibers();
+
+    /** Topology detected when the workers were created */
+    [[nodiscard]] static const CpuTopology& get_topology();
+
+    /** Jobs of the given priority waiting in any queue */
+    [[nodiscard]] static int64_t get_queued_job_count(JobPriority priority);
+
+  private:
+    friend class Fiber;
+
+    Worker(uint32_t worker_id, bool is_background_only, const CpuTopology::LogicalCpu* cpu);
+
+    static void thread_main(uint32_t worker_id);
+
+    void next_task();
+    void wait_for_task();
+    void execute_task(IJobTask* task);
+
+    // Run the job on the calling stack. The job may be suspended and resumed on another worker when it runs on a fiber.
+    static void execute_task_inline(IJobTask* task);
+
+    // Fiber mode
+    static void fiber_main(Fiber* fiber);
+    static void schedule_fiber(Fiber* fiber);
+    void        run_fiber(Fiber* fiber);
+    bool        resume_ready_fiber();
+
+    // Returned jobs carry the reference previously owned by their queue
+    [[nodiscard]] IJobTask* find_task();
+    [[nodiscard]] IJobTask* find_task(JobPriority priority);
+    [[nodiscard]] IJobTask* steal_task(JobPriority priority);
+    [[nodiscard]] bool      has_runnable_jobs() const;
+
+    std::atomic<IJobTask*>       current_task = nullptr;
+    TWorkStealingQueue<IJobTask> local_queues[JOB_PRIORITY_COUNT];
+    uint64_t                     random_state;
+    std::atomic_uint64_t         stat_spins = 0;
+    std::atomic_uint64_t         stat_parks = 0;
+    std::atomic_bool             run        = true;
+    uint32_t                     id;
+    uint32_t                     numa_node  = 0;
+    int32_t                      pinned_cpu = -1;
+    bool                         background_only;
+    std::thread                  worker_thread;
 };
-} // namespace job_system
\ No newline at end of file
+} // namespace job_system
@@ -1,6 +1,7 @@
 
 #include "deferred_renderer.h"
 
+#include "assets/asset_load_graph.h"
 #include "assets/asset_material.h"
 #include "assets/asset_material_instance.h"
 #include "rendering/graphics.h"
@@ -67,7 +68,7 @@ RendererConfiguration create_configuration()
         });
 }
 
-void DeferredRenderer::create_deferred_assets()
+void DeferredRenderer::create_deferred_assets(AssetLoadGraph& load_graph)
 {
     // Deferred combine
     {
@@ -75,22 +76,24 @@ void DeferredRenderer::create_deferred_assets()
             .shader_stage = VK_SHADER_STAGE_VERTEX_BIT,
             .vertex_inputs_override = VertexInputInfo{},
         };
-        const auto vertex_shader = AssetManager::get()->create<AShader>("deferred_resolve_vertex_shader", "data/shaders/deferred_resolve.vert.glsl", vertex_config);
+        load_graph.add<AShader>("deferred_resolve_vertex_shader", {}, "data/shaders/deferred_resolve.vert.glsl", vertex_config);
 
+        // Framebuffer images are created with the renderer and referenced by id : they are not dependencies
         const ShaderInfos fragment_config{
             .shader_stage         = VK_SHADER_STAGE_FRAGMENT_BIT,
             .use_view_data_buffer = true,
             .textures{
-                TextureProperty{.binding_name = "samplerAlbedo", .texture = TAssetPtr<ATexture>("framebuffer_image-render_scene_0")},
-                TextureProperty{.binding_name = "samplerNormal", .texture = TAssetPtr<ATexture>("framebuffer_image-render_scene_1")},
-                TextureProperty{.binding_name = "samplerPosition", .texture = TAssetPtr<ATexture>("framebuffer_image-render_scene_2")},
+                TextureProperty{.binding_name = "samplerAlbedo", .texture = TAssetPtr<ATexture>("framebuffer_image-render_scene_0"_asset)},
+                TextureProperty{.binding_name = "samplerNormal", .texture = TAssetPtr<ATexture>("framebuffer_image-render_scene_1"_asset)},
+                TextureProperty{.binding_name = "samplerPosition", .texture = TAssetPtr<ATexture>("framebuffer_image-render_scene_2"_asset)},
             },
         };
-        auto fragment_shader = AssetManager::get()->create<AShader>("deferred_resolve_fragment_shader", "data/shaders/deferred_resolve.frag.glsl", fragment_config, vertex_shader);
+        load_graph.add<AShader>("deferred_resolve_fragment_shader", {"deferred_resolve_vertex_shader"}, "data/shaders/deferred_resolve.frag.glsl", fragment_config,
+                                TAssetPtr<AShader>("deferred_resolve_vertex_shader"_asset));
 
         MaterialInfos material_infos{
-            .vertex_stage    = vertex_shader,
-            .fragment_stage  = fragment_shader,
+            .vertex_stage    = TAssetPtr<AShader>("deferred_resolve_vertex_shader"_asset),
+            .fragment_stage  = TAssetPtr<AShader>("deferred_resolve_fragment_shader"_asset),
             .renderer_passes = {"combine_deferred"},
             .pipeline_infos{
                 .depth_test       = false,
@@ -98,8 +101,8 @@ void DeferredRenderer::create_deferred_assets()
                 .backface_culling = false,
             },
         };
-        const auto material = AssetManager::get()->create<AMaterialBase>("deferred_resolve_material_base", material_infos);
-        AssetManager::get()->create<AMaterialInstance>("deferred_resolve_material", material);
+        load_graph.add<AMaterialBase>("deferred_resolve_material_base", {"deferred_resolve_vertex_shader", "deferred_resolve_fragment_shader"}, material_infos);
+        load_graph.add<AMaterialInstance>("deferred_resolve_material", {"deferred_resolve_material_base"}, TAssetPtr<AMaterialBase>("deferred_resolve_material_base"_asset));
     }
 }
 } // namespace DeferredRenderer
\ No newline at end of file
@@ -1,8 +1,10 @@
 
 #include "rendering/renderer/renderer.h"
 
+class AssetLoadGraph;
+
 namespace DeferredRenderer
 {
 RendererConfiguration create_configuration();
-void                  create_deferred_assets();
+void                  create_deferred_assets(AssetLoadGraph& load_graph);
 } // namespace DeferredRenderer
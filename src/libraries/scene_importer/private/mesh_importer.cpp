@@ -5,6 +5,7 @@
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
 
+#include "jobSystem/parallel_for.h"
 #include <cpputils/logger.hpp>
 
 TAssetPtr<AMeshData> MeshImporter::import_mesh(const std::filesystem::path& file_path, const std::string& asset_name, const std::string& desired_node)
@@ -70,8 +71,7 @@ TAssetPtr<AMeshData> MeshImporter::process_mesh(const AssetId& asset_id, aiMesh*
     std::vector<Vertex> vertex_group;
 
     vertex_group.resize(mesh->mNumVertices);
-    for (size_t i = 0; i < mesh->mNumVertices; ++i)
-    {
+    job_system::parallel_for<size_t>(0, mesh->mNumVertices, 1024, [&vertex_group, mesh](size_t i) {
         vertex_group[i].pos = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
 
         if (mesh->HasTextureCoords(0))
@@ -85,7 +85,7 @@ TAssetPtr<AMeshData> MeshImporter::process_mesh(const AssetId& asset_id, aiMesh*
             vertex_group[i].tang   = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
             vertex_group[i].bitang = glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
         }
-    }
+    });
 
     // Get triangles
     std::vector<uint32_t> triangles(mesh->mNumFaces * 3);
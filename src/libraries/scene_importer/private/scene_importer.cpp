@@ -8,6 +8,7 @@
 
 #include <cpputils/logger.hpp>
 
+#include <assets/asset_load_graph.h>
 #include <assets/asset_material.h>
 #include <assets/asset_material_instance.h>
 #include <assets/asset_texture.h>
@@ -57,7 +58,7 @@ std::shared_ptr<NodeBase> SceneImporter::create_node(const aiScene* scene, aiNod
     return node;
 }
 
-void SceneImporter::create_default_resources()
+void SceneImporter::create_default_resources(AssetLoadGraph& load_graph)
 {
     // Gltf Shader
     {
@@ -66,24 +67,24 @@ void SceneImporter::create_default_resources()
             .use_view_data_buffer    = true,
             .use_scene_object_buffer = true,
         };
-        const auto vertex_shader = AssetManager::get()->create<AShader>("gltf_vertex_shader", "data/shaders/gltf.vs.glsl", vertex_infos);
+        load_graph.add<AShader>("gltf_vertex_shader", {}, "data/shaders/gltf.vs.glsl", vertex_infos);
 
         const ShaderInfos fragment_infos{
             .shader_stage = VK_SHADER_STAGE_FRAGMENT_BIT,
             .textures{
-                TextureProperty{.binding_name = "diffuse_color", .texture = TAssetPtr<ATexture>("default_texture")},
+                TextureProperty{.binding_name = "diffuse_color", .texture = TAssetPtr<ATexture>("default_texture"_asset)},
             },
         };
 
-        const auto fragment_shader = AssetManager::get()->create<AShader>("gltf_fragment_shader", "data/shaders/gltf.fs.glsl", fragment_infos, vertex_shader);
+        load_graph.add<AShader>("gltf_fragment_shader", {"default_texture", "gltf_vertex_shader"}, "data/shaders/gltf.fs.glsl", fragment_infos, TAssetPtr<AShader>("gltf_vertex_shader"_asset));
 
         MaterialInfos material_infos{
-            .vertex_stage    = vertex_shader,
-            .fragment_stage  = fragment_shader,
+            .vertex_stage    = TAssetPtr<AShader>("gltf_vertex_shader"_asset),
+            .fragment_stage  = TAssetPtr<AShader>("gltf_fragment_shader"_asset),
             .renderer_passes = {"render_scene"},
         };
 
-        AssetManager::get()->create<AMaterialBase>("gltf_base_material", material_infos);
+        load_graph.add<AMaterialBase>("gltf_base_material", {"gltf_vertex_shader", "gltf_fragment_shader"}, material_infos);
     }
 }
 
@@ -150,7 +151,8 @@ TAssetPtr<ATexture2D> SceneImporter::process_texture(aiTexture* texture, size_t
     }
 
     const auto asset_id = AssetManager::get()->find_valid_asset_id(object_name + "_texture_" + std::string(texture->mFilename.C_Str()));
-    auto       text     = AssetManager::get()->create<ATexture2D>(asset_id, std::vector<uint8_t>(data, data + width * height * 4), width, height, channels);
+    // Uploaded by a background job : materials use the default texture meanwhile
+    auto       text     = AssetManager::get()->create_async<ATexture2D>(asset_id, std::vector<uint8_t>(data, data + width * height * 4), width, height, channels);
 
     return text;
 }
@@ -181,10 +183,10 @@ TAssetPtr<AMaterialInstance> SceneImporter::process_material(const aiScene* scen
     LOG_DEBUG("using diffuse %d", diffuse_index);
 
     const auto instance_id       = AssetManager::get()->find_valid_asset_id(object_name + "_material_instance_" + std::string(material->GetName().C_Str()));
-    auto       material_instance = AssetManager::get()->create<AMaterialInstance>(instance_id, TAssetPtr<AMaterialBase>("gltf_base_material"));
+    auto       material_instance = AssetManager::get()->create<AMaterialInstance>(instance_id, TAssetPtr<AMaterialBase>("gltf_base_material"_asset));
 
     if (diffuse_index >= 0)
-        material_instance->set_texture("diffuse_color", static_cast<ATexture*>(texture_refs[diffuse_index].get()));
+        material_instance->set_texture("diffuse_color", TAssetPtr<ATexture>(texture_refs[diffuse_index].id()));
 
     return material_instance;
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <assimp/Importer.hpp>
 
 class AMaterialInstance;
+class AssetLoadGraph;
 class Scene;
 struct aiNode;
 class AMeshData;
@@ -24,7 +25,7 @@ class SceneImporter final
     {
     }
 
-    static void create_default_resources();
+    static void create_default_resources(AssetLoadGraph& load_graph);
 
     std::shared_ptr<NodeBase> import_file(const std::filesystem::path& source_file, const std::string& asset_name, Scene* context_scene);
 
@@ -0,0 +1,37 @@
+#include "assets/asset_id.h"
+
+#include <cpputils/logger.hpp>
+
+#include <string>
+#include <string_view>
+
+// Reference FNV-1a 64 bit hashes : literals must match them without going through AssetId::hash() twice
+static_assert(""_asset == AssetId(0xcbf29ce484222325ull));
+static_assert("a"_asset == AssetId(0xaf63dc4c8601ec8cull));
+static_assert("foobar"_asset == AssetId(0x85944171f73967e8ull));
+
+void test_asset_ids()
+{
+	// Names built at runtime, and views that are not null terminated, must give the id of the literal
+	const std::string built_name = std::string("default_") + "texture";
+	if (AssetId(built_name) != "default_texture"_asset)
+		LOG_FATAL("asset ids : runtime id of %s doesn't match its literal", built_name.c_str());
+	const std::string_view truncated_name = std::string_view("foobarbaz").substr(0, 6);
+	if (AssetId(truncated_name) != "foobar"_asset || AssetId(truncated_name) == AssetId("foobarbaz"))
+		LOG_FATAL("asset ids : runtime id of a string view doesn't match its literal");
+
+	// Runtime ids intern their name, literals find it back
+	if ("default_texture"_asset.to_string() != "default_texture" || "foobar"_asset.to_string() != "foobar")
+		LOG_FATAL("asset ids : interned name was not found back");
+	constexpr AssetId never_interned = "never_interned_name"_asset;
+	if (never_interned.to_string() != std::to_string(never_interned()))
+		LOG_FATAL("asset ids : a name never seen at runtime was found");
+
+	LOG_VALIDATE("asset ids");
+}
+
+int main()
+{
+	test_asset_ids();
+	LOG_VALIDATE("complete");
+}
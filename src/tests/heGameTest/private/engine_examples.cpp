@@ -29,7 +29,7 @@ void create_material()
         .shader_stage = VK_SHADER_STAGE_FRAGMENT_BIT, // This shader will be used for fragment stage
         .textures{
             // An array of textures available in the given material
-            TextureProperty{.binding_name = "p_diffuse", .texture = TAssetPtr<ATexture>("default_texture")},
+            TextureProperty{.binding_name = "p_diffuse", .texture = TAssetPtr<ATexture>("default_texture"_asset)},
         },
     };
     const TAssetPtr<AShader> fragment_shader = AssetManager::get()->create<AShader>("demo_vertex_shader", "data/shaders/default.fs.glsl", fragment_config, vertex_shader);
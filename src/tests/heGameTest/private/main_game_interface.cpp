@@ -1,6 +1,7 @@
 
 #include "main_game_interface.h"
 
+#include "assets/asset_load_graph.h"
 #include "assets/asset_material.h"
 #include "assets/asset_material_instance.h"
 #include "assets/asset_texture.h"
@@ -28,20 +29,20 @@ RendererConfiguration MainGameInterface::get_default_render_pass_configuration()
         main_camera->update_view(*render_context);
     });
 
-    deferred_config.add_render_pass(ImGuiImplementation::get_ui_render_pass(TAssetPtr<ATexture>("framebuffer_image-combine_deferred_0"), imgui_instance));
+    deferred_config.add_render_pass(ImGuiImplementation::get_ui_render_pass(TAssetPtr<ATexture>("framebuffer_image-combine_deferred_0"_asset), imgui_instance));
 
     deferred_config.get_render_pass("ui_render_pass")->on_pass_rendering.add_lambda([&](SwapchainFrame* render_context) {
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
         auto mat = imgui_instance->material_instance->get_material_base()->get_pipeline("ui_render_pass");
-        if (!TAssetPtr<ATexture>("framebuffer_image-combine_deferred_0") || !mat)
+        if (!TAssetPtr<ATexture>("framebuffer_image-combine_deferred_0"_asset) || !mat)
         {
             LOG_FATAL("background image is null");
         }
 
         ImGui::GetBackgroundDrawList()->AddImage(
-            TAssetPtr<ATexture>("framebuffer_image-combine_deferred_0")->get_imgui_handle(render_context->image_index, *mat->get_descriptor_sets_layouts()), ImVec2{0, 0},
+            TAssetPtr<ATexture>("framebuffer_image-combine_deferred_0"_asset)->get_imgui_handle(render_context->image_index, *mat->get_descriptor_sets_layouts()), ImVec2{0, 0},
             ImVec2{static_cast<float>(Graphics::get()->get_swapchain()->get_swapchain_extend().width), static_cast<float>(Graphics::get()->get_swapchain()->get_swapchain_extend().height)});
 
         if (ImGui::BeginMainMenuBar())
@@ -97,10 +98,10 @@ GfxInterface* MainGameInterface::create_graphic_interface()
     return new CustomGraphicInterface();
 }
 
-static void create_default_objects()
+static void create_default_objects(AssetLoadGraph& load_graph)
 {
     // Create textures
-    AssetManager::get()->create<ATexture2D>("default_texture", std::vector<uint8_t>{255, 255, 255, 255}, 1, 1, 4);
+    load_graph.add<ATexture2D>("default_texture", {}, std::vector<uint8_t>{255, 255, 255, 255}, 1, 1, 4);
 
     // Create shaders
 
@@ -111,34 +112,37 @@ static void create_default_objects()
             .use_view_data_buffer    = true,
             .use_scene_object_buffer = true,
         };
-        const auto vertex_shader = AssetManager::get()->create<AShader>("default_vertex_shader", "data/shaders/default.vs.glsl", vertex_config);
+        load_graph.add<AShader>("default_vertex_shader", {}, "data/shaders/default.vs.glsl", vertex_config);
 
         const ShaderInfos fragment_config{
             .shader_stage = VK_SHADER_STAGE_FRAGMENT_BIT,
             .textures{
-                TextureProperty{.binding_name = "p_diffuse", .texture = TAssetPtr<ATexture>("default_texture")},
+                TextureProperty{.binding_name = "p_diffuse", .texture = TAssetPtr<ATexture>("default_texture"_asset)},
             },
         };
-        const auto fragment_shader = AssetManager::get()->create<AShader>("default_fragment_shader", "data/shaders/default.fs.glsl", fragment_config, vertex_shader);
+        load_graph.add<AShader>("default_fragment_shader", {"default_texture", "default_vertex_shader"}, "data/shaders/default.fs.glsl", fragment_config, TAssetPtr<AShader>("default_vertex_shader"_asset));
 
         MaterialInfos material_infos{
-            .vertex_stage    = vertex_shader,
-            .fragment_stage  = fragment_shader,
+            .vertex_stage    = TAssetPtr<AShader>("default_vertex_shader"_asset),
+            .fragment_stage  = TAssetPtr<AShader>("default_fragment_shader"_asset),
             .renderer_passes = {"render_scene"},
         };
-        const auto material = AssetManager::get()->create<AMaterialBase>("default_material_base", material_infos);
-        AssetManager::get()->create<AMaterialInstance>("default_material", material);
+        load_graph.add<AMaterialBase>("default_material_base", {"default_vertex_shader", "default_fragment_shader"}, material_infos);
+        load_graph.add<AMaterialInstance>("default_material", {"default_material_base"}, TAssetPtr<AMaterialBase>("default_material_base"_asset));
     }
 
     // Create meshes
-    primitive::create_primitive<primitive::CubePrimitive>("default_cube");
+    load_graph.add_custom("default_cube", {}, [] { return static_cast<bool>(primitive::create_primitive<primitive::CubePrimitive>("default_cube")); });
 }
 
 void MainGameInterface::engine_load_resources()
 {
-    create_default_objects();
-    DeferredRenderer::create_deferred_assets();
-    SceneImporter::create_default_resources();
+    // Independent assets are created in parallel
+    AssetLoadGraph load_graph;
+    create_default_objects(load_graph);
+    DeferredRenderer::create_deferred_assets(load_graph);
+    SceneImporter::create_default_resources(load_graph);
+    load_graph.load();
     // Create scene
     root_scene = std::make_unique<Scene>();
     NMesh::register_component(root_scene.get());
@@ -159,7 +163,7 @@ void MainGameInterface::engine_load_resources()
      scene_importer.import_file("data/models/bistro.glb", "cafe_ext", root_scene.get());
     // scene_importer.import_file("data/models/bistro_interior.glb", "cafe_int", root_scene.get());
     // scene_importer.import_file("data/models/sibenik.glb", "sponza_elem", root_scene.get());
-    // root_scene->add_node<NMesh>("cube", TAssetPtr<AMeshData>("default_cube"), TAssetPtr<AMaterialBase>("default_material"));
+    // root_scene->add_node<NMesh>("cube", TAssetPtr<AMeshData>("default_cube"_asset), TAssetPtr<AMaterialBase>("default_material"_asset));
 
     const auto sponza_root = scene_importer.import_file("data/models/sponza.glb", "sponza_elem", root_scene.get());
     const int max_x = 10, max_y = 10;
@@ -1,6 +1,33 @@
+#include "frame_profiler.h"
 #include "jobSystem/job_system.h"
+#include "jobSystem/job_trace.h"
+#include "jobSystem/parallel_for.h"
+#include "jobSystem/task.h"
+#include "jobSystem/task_graph.h"
+#include "memory_tracker.h"
+#include "perf_counters.h"
+#include "profiler_capture.h"
+#include "statsRecorder.h"
+#include "telemetry.h"
+#include "types/concurrent_ptr_map.h"
+#include "types/fast_mutex.h"
+#include "types/objectPool.h"
+#include "types/slot_map.h"
 
+#include <cpputils/logger.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 #define TASK for (size_t i = 0; i < 1000000000; ++i) {}
 
@@ -10,8 +37,656 @@ void tests()
 }
 
 
+void test_work_stealing()
+{
+	// Every job must run exactly once, whoever pops or steals it
+	std::atomic_int executed = 0;
+	job_system::new_job([&executed]
+		{
+			for (int i = 0; i < 10000; ++i)
+			{
+				job_system::new_job([&executed]
+					{
+						job_system::new_job([&executed] { ++executed; });
+						++executed;
+					});
+			}
+		})->wait();
+
+	if (executed != 20000)
+		LOG_FATAL("work stealing : expected 20000 executed jobs, got %d", executed.load());
+	LOG_VALIDATE("work stealing");
+}
+
+void test_parallel_for()
+{
+	std::vector<int> values(100000, 0);
+	job_system::parallel_for<size_t>(0, values.size(), 0, [&values](size_t i) { values[i] += static_cast<int>(i % 7); });
+
+	const int64_t sum = job_system::parallel_reduce<size_t, int64_t>(0, values.size(), 64, 0, [&values](size_t i) -> int64_t { return values[i]; }, [](int64_t a, int64_t b) { return a + b; });
+
+	int64_t expected = 0;
+	for (size_t i = 0; i < values.size(); ++i)
+		expected += static_cast<int64_t>(i % 7);
+
+	if (sum != expected)
+		LOG_FATAL("parallel_for : expected sum %ld, got %ld", expected, sum);
+	LOG_VALIDATE("parallel for");
+}
+
+void test_task_graph()
+{
+	// input -> (tick, asset gc) -> culling -> upload, submitted again each frame
+	std::atomic_int step = 0;
+	int             input = -1, tick = -1, gc = -1, culling = -1, upload = -1;
+
+	job_system::TaskGraph graph;
+	const auto input_task   = graph.add_task("input", [&] { input = step++; });
+	const auto tick_task    = graph.add_task("tick", [&] { tick = step++; }, {input_task});
+	const auto gc_task      = graph.add_task("asset_gc", [&] { gc = step++; }, {input_task});
+	const auto culling_task = graph.add_task("culling", [&] { culling = step++; }, {tick_task, gc_task});
+	graph.add_task("upload", [&] { upload = step++; }, {culling_task});
+
+	for (int frame = 0; frame < 100; ++frame)
+	{
+		step = 0;
+		graph.submit()->wait();
+		if (step != 5 || input != 0 || tick <= input || gc <= input || culling <= tick || culling <= gc || upload <= culling)
+			LOG_FATAL("task graph : dependencies were not respected");
+	}
+
+	job_system::TaskGraph cyclic_graph;
+	const auto first = cyclic_graph.add_task("first", [] {});
+	const auto second = cyclic_graph.add_task("second", [] {}, {first});
+	cyclic_graph.add_dependency(first, second);
+	if (cyclic_graph.submit())
+		LOG_FATAL("task graph : cycle was not detected");
+
+	LOG_VALIDATE("task graph");
+}
+
+void test_job_priorities()
+{
+	// Critical jobs are pushed first : once one background job runs, no critical job may still be waiting
+	std::atomic_int executed = 0;
+	std::atomic_bool policy_broken = false;
+	job_system::new_job([&]
+		{
+			for (int i = 0; i < 1000; ++i)
+				job_system::new_job([&executed] { ++executed; }, job_system::JobPriority::Critical);
+			for (int i = 0; i < 1000; ++i)
+				job_system::new_job([&]
+					{
+						if (job_system::Worker::get_queued_job_count(job_system::JobPriority::Critical) != 0)
+							policy_broken = true;
+						++executed;
+					}, job_system::JobPriority::Background);
+		})->wait();
+
+	if (policy_broken)
+		LOG_FATAL("job priorities : a background job ran while critical jobs were pending");
+	if (executed != 2000)
+		LOG_FATAL("job priorities : expected 2000 executed jobs, got %d", executed.load());
+
+	// Children inherit the priority of their parent
+	job_system::JobPriority child_priority = job_system::JobPriority::Normal;
+	job_system::new_job([&child_priority] { child_priority = job_system::new_job([] {})->priority; }, job_system::JobPriority::Critical)->wait();
+	if (child_priority != job_system::JobPriority::Critical)
+		LOG_FATAL("job priorities : child did not inherit its parent priority");
+
+	LOG_VALIDATE("job priorities");
+}
+
+void test_job_trace()
+{
+	job_system::trace::clear();
+	job_system::trace::start();
+	job_system::new_job([]
+		{
+			for (int i = 0; i < 100; ++i)
+				job_system::new_job([] {});
+		})->wait();
+	job_system::trace::stop();
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "js_test_trace.json";
+	if (!job_system::trace::export_chrome_trace(path))
+		LOG_FATAL("job trace : export failed");
+
+	std::ifstream file(path);
+	const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+	std::filesystem::remove(path);
+	if (content.find("\"traceEvents\"") == std::string::npos || content.find("\"ph\":\"X\"") == std::string::npos)
+		LOG_FATAL("job trace : exported file does not contain job slices");
+
+	// Counters are sharded per thread : the sum must still be exact
+	if (job_system::IJobTask::get_stat_awaiting_job_count() < 0)
+		LOG_FATAL("job trace : negative awaiting job count");
+
+	LOG_VALIDATE("job trace");
+}
+
+void test_frame_profiler()
+{
+#if PROFILER_DISABLED
+	LOG_INFO("frame profiler : skipped, profiling is compiled out");
+	return;
+#endif
+	FrameProfiler& profiler = FrameProfiler::get();
+	profiler.set_history_size(32);
+	profiler.set_enabled(true);
+	for (int frame = 0; frame < 40; ++frame)
+	{
+		{
+			BEGIN_NAMED_RECORD(TEST_FRAME);
+			job_system::parallel_for<size_t>(0, 256, 16, [](size_t) { BEGIN_NAMED_RECORD(TEST_ITEM); });
+		}
+		profiler.end_frame();
+	}
+	profiler.set_enabled(false);
+
+	if (profiler.get_frame_count() != 32)
+		LOG_FATAL("frame profiler : expected 32 kept frames, got %zu", profiler.get_frame_count());
+
+	const auto frame_scope = profiler.find_scope("TEST_FRAME");
+	if (!frame_scope || frame_scope->frame_count != 32 || frame_scope->parent != FrameProfiler::NO_PARENT)
+		LOG_FATAL("frame profiler : TEST_FRAME scope was not aggregated");
+	const FrameProfiler::Percentiles& inclusive = frame_scope->inclusive;
+	if (inclusive.p50 > inclusive.p95 || inclusive.p95 > inclusive.p99 || inclusive.p99 > inclusive.max || frame_scope->exclusive.p50 > inclusive.p50)
+		LOG_FATAL("frame profiler : inconsistent TEST_FRAME percentiles");
+
+	// Items run on any worker, possibly nested in different parents : every path counts
+	uint32_t item_calls = 0;
+	for (const FrameProfiler::ScopeReport& scope : profiler.get_report())
+		if (scope.name == std::string_view("TEST_ITEM"))
+			item_calls += scope.last_calls;
+	if (item_calls != 256)
+		LOG_FATAL("frame profiler : expected 256 TEST_ITEM calls in the last frame, got %u", item_calls);
+
+	LOG_VALIDATE("frame profiler");
+}
+
+void test_perf_counters()
+{
+	using perf_counters::Counter;
+	if (perf_counters::is_available())
+	{
+		perf_counters::Sample begin, end;
+		volatile size_t sum = 0;
+		if (!perf_counters::read(begin))
+			LOG_FATAL("perf counters : read failed");
+		for (size_t i = 0; i < 100000; ++i)
+			sum = sum + i;
+		if (!perf_counters::read(end) || end.group != begin.group)
+			LOG_FATAL("perf counters : read failed");
+		if (end[Counter::Instructions] < begin[Counter::Instructions] + 100000 || end[Counter::Cycles] <= begin[Counter::Cycles])
+			LOG_FATAL("perf counters : counters did not increase");
+	}
+	else
+		LOG_INFO("perf counters : not available, only testing the capture");
+
+	// Counted stats round trip through the capture, next to plain stats
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "js_test_counters.hecap";
+	const ProfilerScope& scope = profiler_scope::register_scope("TEST_COUNTED", __FUNCTION__, __FILE__, __LINE__, profiler_scope::DEFAULT_COLOR, true);
+	const uint64_t counters[perf_counters::COUNTER_COUNT] = {4000, 6000, 12, 300};
+	{
+		profiler_capture::Writer writer;
+		if (!writer.open(path))
+			LOG_FATAL("perf counters : cannot open %s", path.string().c_str());
+		writer.write(scope, std::this_thread::get_id(), 100, 50);
+		writer.write(scope, std::this_thread::get_id(), 200, 60, counters);
+	}
+	profiler_capture::Reader reader;
+	profiler_capture::Sample plain, counted, none;
+	if (!reader.open(path) || !reader.next(plain) || !reader.next(counted) || reader.next(none) || reader.is_corrupted())
+		LOG_FATAL("perf counters : cannot read the capture back");
+	if (plain.has_counters || !counted.has_counters || counted.start != 200 || counted.duration != 60 || counted.get_counter(Counter::Instructions) != 6000 ||
+	    counted.get_counter(Counter::BranchMisses) != 300)
+		LOG_FATAL("perf counters : counted stat mismatch");
+	std::filesystem::remove(path);
+
+	LOG_VALIDATE("perf counters");
+}
+
+void test_telemetry()
+{
+	// Buckets hold their duration within the histogram precision
+	for (uint64_t duration = 1; duration < (1ull << 40); duration = duration * 3 + 1)
+	{
+		const uint64_t bucket_max = telemetry::get_bucket_max(telemetry::get_bucket(duration));
+		if (bucket_max < duration || bucket_max - duration > duration / telemetry::SUB_BUCKET_COUNT)
+			LOG_FATAL("telemetry : duration %lu is in a bucket up to %lu", duration, bucket_max);
+	}
+
+	telemetry::reset();
+	const ProfilerScope& scope = profiler_scope::register_scope("TEST_TELEMETRY", __FUNCTION__, __FILE__, __LINE__);
+	// 1..1000us, then a single 50ms hitch
+	for (uint64_t i = 1; i <= 1000; ++i)
+		telemetry::record(scope.id, i * 1000);
+	telemetry::record(scope.id, 50000000);
+
+	const std::vector<telemetry::ScopeStats> stats = telemetry::get_stats();
+	const auto found = std::find_if(stats.begin(), stats.end(), [&](const telemetry::ScopeStats& scope_stats) { return scope_stats.scope == scope.id; });
+	if (found == stats.end() || found->calls != 1001 || found->max_ns != 50000000)
+		LOG_FATAL("telemetry : TEST_TELEMETRY was not recorded");
+	const auto near = [](uint64_t value, uint64_t expected) { return value >= expected && value - expected <= expected / telemetry::SUB_BUCKET_COUNT + 1000; };
+	if (!near(found->p50_ns, 500000) || !near(found->p99_ns, 990000) || found->p999_ns > found->max_ns)
+		LOG_FATAL("telemetry : unexpected percentiles p50=%lu p99=%lu", found->p50_ns, found->p99_ns);
+
+#if !PROFILER_DISABLED
+	// Recorded scopes feed the histograms without any profiler record running
+	telemetry::set_enabled(true);
+	job_system::parallel_for<size_t>(0, 256, 16, [](size_t) { BEGIN_NAMED_RECORD(TEST_TELEMETRY_ITEM); });
+	telemetry::set_enabled(false);
+	uint64_t item_calls = 0;
+	for (const telemetry::ScopeStats& scope_stats : telemetry::get_stats())
+		if (profiler_scope::get(scope_stats.scope).name == std::string_view("TEST_TELEMETRY_ITEM"))
+			item_calls += scope_stats.calls;
+	if (item_calls != 256)
+		LOG_FATAL("telemetry : expected 256 TEST_TELEMETRY_ITEM calls, got %lu", item_calls);
+#endif
+
+	std::stringstream report;
+	telemetry::dump(report);
+	if (report.str().find("TEST_TELEMETRY") == std::string::npos)
+		LOG_FATAL("telemetry : TEST_TELEMETRY is missing from the dump");
+
+	telemetry::request_dump();
+	const std::filesystem::path dump_path = telemetry::poll_dump_request(std::filesystem::temp_directory_path());
+	if (dump_path.empty() || !std::filesystem::exists(dump_path) || !telemetry::poll_dump_request(std::filesystem::temp_directory_path()).empty())
+		LOG_FATAL("telemetry : requested dump was not written once");
+	std::filesystem::remove(dump_path);
+
+	LOG_VALIDATE("telemetry");
+}
+
+void test_mpmc_queue()
+{
+	// A small ring : most of the values go through the overflow segment
+	constexpr size_t THREADS = 4;
+	constexpr size_t VALUES_PER_PRODUCER = 50000;
+	constexpr size_t VALUE_COUNT = THREADS * VALUES_PER_PRODUCER;
+	auto queue = std::make_unique<TMpmcQueue<size_t, 64>>();
+	std::vector<std::atomic_uint8_t> seen(VALUE_COUNT);
+	std::atomic_size_t consumed = 0;
+	std::vector<std::thread> threads;
+	for (size_t producer = 0; producer < THREADS; ++producer)
+		threads.emplace_back([&, producer]
+		{
+			for (size_t i = 0; i < VALUES_PER_PRODUCER; ++i)
+				queue->push(producer * VALUES_PER_PRODUCER + i);
+		});
+	for (size_t consumer = 0; consumer < THREADS; ++consumer)
+		threads.emplace_back([&]
+		{
+			size_t value;
+			while (consumed.load(std::memory_order_relaxed) < VALUE_COUNT)
+			{
+				if (!queue->pop(value))
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				if (value >= VALUE_COUNT || seen[value].fetch_add(1, std::memory_order_relaxed) != 0)
+					LOG_FATAL("mpmc queue : value %zu popped twice or invalid", value);
+				consumed.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	for (auto& thread : threads)
+		thread.join();
+	if (!queue->is_empty())
+		LOG_FATAL("mpmc queue : %zu values left after every value was consumed", queue->size());
+
+	// A single producer pops in push order, the overflow included
+	for (size_t i = 0; i < 200; ++i)
+		queue->push(i);
+	for (size_t i = 0, value; i < 200; ++i)
+		if (!queue->pop(value) || value != i)
+			LOG_FATAL("mpmc queue : values were not popped in push order");
+
+	// TObjectPool used to abort past its size
+	TObjectPool<size_t, 16> pool;
+	for (size_t i = 0; i < 100; ++i)
+		pool.push(std::make_shared<size_t>(i));
+	size_t popped = 0;
+	while (const std::shared_ptr<size_t> object = pool.pop())
+		if (*object == popped)
+			++popped;
+	if (popped != 100 || !pool.is_empty())
+		LOG_FATAL("mpmc queue : object pool lost objects past its size");
+
+	LOG_VALIDATE("mpmc queue");
+}
+
+void test_fast_mutex()
+{
+	FastMutex mutex("test mutex");
+	bool named = false;
+	FastMutex::for_each_named_lock([&](const FastMutex& other) { named = named || &other == &mutex; });
+	if (!named)
+		LOG_FATAL("fast mutex : named lock was not registered");
+
+	// Exclusion under contention
+	constexpr size_t THREADS = 4;
+	constexpr size_t INCREMENTS = 20000;
+	size_t counter = 0;
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < THREADS; ++i)
+		threads.emplace_back([&]
+		{
+			for (size_t j = 0; j < INCREMENTS; ++j)
+			{
+				std::lock_guard lock(mutex);
+				++counter;
+			}
+		});
+	for (auto& thread : threads)
+		thread.join();
+	if (counter != THREADS * INCREMENTS)
+		LOG_FATAL("fast mutex : expected %zu increments, got %zu", THREADS * INCREMENTS, counter);
+
+	// A thread waiting longer than the backoff parks, and is woken up by unlock
+	mutex.reset_stats();
+	mutex.lock();
+	if (mutex.try_lock())
+		LOG_FATAL("fast mutex : try_lock succeeded on a locked mutex");
+	std::thread waiter([&]
+	{
+		std::lock_guard lock(mutex);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	mutex.unlock();
+	waiter.join();
+	const FastMutex::Stats stats = mutex.get_stats();
+	if (stats.contentions != 1 || stats.parks == 0 || stats.wait_time < std::chrono::milliseconds(10))
+		LOG_FATAL("fast mutex : unexpected stats (contentions=%lu, parks=%lu)", stats.contentions, stats.parks);
+	if (!mutex.try_lock())
+		LOG_FATAL("fast mutex : try_lock failed on an unlocked mutex");
+	mutex.unlock();
+
+	LOG_VALIDATE("fast mutex");
+}
+
+void test_slot_map()
+{
+	const memory::TagStats before = memory::get_stats(MemoryTag::SceneProxy);
+	{
+		TSlotMap<std::string, memory::TTaggedAllocator<std::string, MemoryTag::SceneProxy>> slot_map;
+		std::vector<SlotHandle> handles;
+		for (size_t i = 0; i < 1000; ++i)
+			handles.emplace_back(slot_map.insert(std::to_string(i)));
+		if (memory::get_stats(MemoryTag::SceneProxy).live_bytes <= before.live_bytes)
+			LOG_FATAL("slot map : storage was not attributed to its allocator tag");
+
+		// Erase every odd object : the others move, their handles stay valid
+		for (size_t i = 1; i < handles.size(); i += 2)
+			if (!slot_map.erase(handles[i]))
+				LOG_FATAL("slot map : failed to erase %zu", i);
+		if (slot_map.size() != 500 || slot_map.erase(handles[1]) || slot_map.get(handles[1]))
+			LOG_FATAL("slot map : erased handle is still valid");
+		for (size_t i = 0; i < handles.size(); i += 2)
+			if (const std::string* object = slot_map.get(handles[i]); !object || *object != std::to_string(i))
+				LOG_FATAL("slot map : handle %zu lost its object", i);
+
+		// Recycled slots don't match outdated handles
+		const SlotHandle recycled = slot_map.insert("recycled");
+		if (recycled.index != handles[999].index || slot_map.contains(handles[999]) || *slot_map.get(SlotHandle::unpack(recycled.pack())) != "recycled")
+			LOG_FATAL("slot map : slot was not recycled with a new generation");
+
+		// Dense iteration covers every object, and maps back to its handle
+		size_t visited = 0;
+		for (size_t i = 0; i < slot_map.size(); ++i, ++visited)
+			if (slot_map.get(slot_map.get_handle(i)) != &slot_map[i])
+				LOG_FATAL("slot map : dense index %zu doesn't match its handle", i);
+		if (visited != 501)
+			LOG_FATAL("slot map : expected 501 objects, got %zu", visited);
+
+		slot_map.clear();
+		if (!slot_map.empty() || slot_map.contains(recycled) || slot_map.contains(handles[0]))
+			LOG_FATAL("slot map : handles are still valid after clear");
+	}
+	if (memory::get_stats(MemoryTag::SceneProxy).live_bytes != before.live_bytes)
+		LOG_FATAL("slot map : storage was not released");
+
+	LOG_VALIDATE("slot map");
+}
+
+void test_concurrent_ptr_map()
+{
+	// Keys of the stable set are never erased : readers must always find them, while writers make the shards grow and churn
+	constexpr size_t STABLE_KEYS = 1000;
+	constexpr size_t CHURN_KEYS = 20000;
+	auto map = std::make_unique<TConcurrentPtrMap<size_t>>();
+	std::vector<size_t> values(STABLE_KEYS + CHURN_KEYS);
+	for (size_t i = 0; i < values.size(); ++i)
+		values[i] = i;
+	for (size_t i = 0; i < STABLE_KEYS; ++i)
+		if (!map->try_insert(i, &values[i]))
+			LOG_FATAL("concurrent map : failed to insert %zu", i);
+
+	std::atomic_bool writing = true;
+	std::vector<std::thread> threads;
+	for (size_t writer = 0; writer < 2; ++writer)
+		threads.emplace_back([&, writer]
+		{
+			for (size_t i = STABLE_KEYS + writer; i < values.size(); i += 2)
+				map->try_insert(i, &values[i]);
+			for (size_t i = STABLE_KEYS + writer; i < values.size(); i += 4)
+				if (map->erase(i) != &values[i])
+					LOG_FATAL("concurrent map : erase of %zu returned a wrong value", i);
+		});
+	for (size_t reader = 0; reader < 2; ++reader)
+		threads.emplace_back([&]
+		{
+			do
+			{
+				for (size_t i = 0; i < STABLE_KEYS; ++i)
+					if (map->find(i) != &values[i])
+						LOG_FATAL("concurrent map : stable key %zu was not found", i);
+				// Erased slots are reused by other keys : a lookup must never return the value of another key
+				for (size_t i = STABLE_KEYS; i < values.size(); ++i)
+					if (const size_t* value = map->find(i); value && *value != i)
+						LOG_FATAL("concurrent map : key %zu returned the value of key %zu", i, *value);
+			} while (writing.load());
+		});
+	threads[0].join();
+	threads[1].join();
+	writing = false;
+	for (size_t i = 2; i < threads.size(); ++i)
+		threads[i].join();
+
+	size_t count = 0;
+	map->for_each([&](uint64_t key, size_t* value)
+	{
+		if (*value != key)
+			LOG_FATAL("concurrent map : key %lu holds value %zu", key, *value);
+		++count;
+	});
+	if (count != map->size() || count != STABLE_KEYS + CHURN_KEYS / 2)
+		LOG_FATAL("concurrent map : expected %zu values, got %zu", STABLE_KEYS + CHURN_KEYS / 2, count);
+
+	// Reserved keys exist but can't be found until published
+	size_t reserved_value = 42;
+	if (!map->try_insert(1u << 30, nullptr) || map->try_insert(1u << 30, &reserved_value) || !map->contains(1u << 30) || map->find(1u << 30))
+		LOG_FATAL("concurrent map : reserved key misbehaves");
+	if (!map->publish(1u << 30, &reserved_value) || map->find(1u << 30) != &reserved_value || map->publish(1u << 30, &reserved_value))
+		LOG_FATAL("concurrent map : reserved key was not published");
+
+	LOG_VALIDATE("concurrent map");
+}
+
+void test_memory_tracking()
+{
+	// Job arena pages are attributed to the job system
+	if (memory::get_stats(MemoryTag::JobSystem).live_bytes <= 0)
+		LOG_FATAL("memory tracking : job system memory was not tracked");
+
+	const memory::TagStats before = memory::get_stats(MemoryTag::SceneProxy);
+	void* data = memory::malloc(1000, MemoryTag::SceneProxy);
+	data = memory::realloc(data, 5000, MemoryTag::SceneProxy);
+	const memory::TagStats during = memory::get_stats(MemoryTag::SceneProxy);
+	memory::free(data);
+	const memory::TagStats after = memory::get_stats(MemoryTag::SceneProxy);
+
+	if (during.live_bytes - before.live_bytes != 5000 || during.live_allocations - before.live_allocations != 1 || during.peak_bytes < during.live_bytes)
+		LOG_FATAL("memory tracking : wrong live stats after realloc");
+	if (after.live_bytes != before.live_bytes || after.live_allocations != before.live_allocations)
+		LOG_FATAL("memory tracking : memory was not released");
+
+	LOG_VALIDATE("memory tracking");
+}
+
+void test_background_workers(int worker_count)
+{
+	if (worker_count < 2)
+		return;
+
+	// Reserve one worker : background jobs only run there, and it runs nothing else
+	job_system::Worker::destroy_workers();
+	job_system::Worker::create_workers(worker_count, 1);
+
+	std::atomic_bool wrong_lane = false;
+	for (int i = 0; i < 1000; ++i)
+	{
+		job_system::new_job([&wrong_lane]
+			{
+				if (!job_system::Worker::get()->is_background_worker())
+					wrong_lane = true;
+			}, job_system::JobPriority::Background);
+		job_system::new_job([&wrong_lane]
+			{
+				if (job_system::Worker::get()->is_background_worker())
+					wrong_lane = true;
+			});
+	}
+	job_system::Worker::wait_job_completion();
+
+	if (wrong_lane)
+		LOG_FATAL("background workers : job executed on the wrong lane");
+	LOG_VALIDATE("background workers");
+}
+
+void test_pinned_workers(int worker_count)
+{
+	// More workers than cpus wraps around the selected cpus
+	job_system::Worker::destroy_workers();
+	job_system::Worker::create_workers(job_system::WorkerSettings{.worker_count = worker_count, .pin_threads = true, .use_smt_siblings = true});
+
+	for (size_t i = 0; i < job_system::Worker::get_worker_count(); ++i)
+		if (job_system::Worker::get_worker(i)->get_pinned_cpu() < 0)
+			LOG_FATAL("pinned workers : worker %zu has no cpu", i);
+
+	test_work_stealing();
+	LOG_VALIDATE("pinned workers");
+}
+
+job_system::Task<int> double_value(int value)
+{
+	co_return value * 2;
+}
+
+job_system::Task<size_t> load_and_process(std::filesystem::path path)
+{
+	// Nested task, job completion and file read : each suspension resumes on a worker
+	const int doubled = co_await double_value(21);
+
+	std::atomic_int children = 0;
+	co_await job_system::new_job([&children]
+		{
+			for (int i = 0; i < 100; ++i)
+				job_system::new_job([&children] { ++children; });
+		});
+
+	const std::vector<uint8_t> data = co_await job_system::read_file_async(path);
+	co_return static_cast<size_t>(doubled + children) + data.size();
+}
+
+void test_coroutines()
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "js_test_coroutine.bin";
+	std::ofstream(path, std::ios::binary) << "0123456789";
+
+	const size_t result = job_system::sync_wait(load_and_process(path));
+	std::filesystem::remove(path);
+	if (result != 42 + 100 + 10)
+		LOG_FATAL("coroutines : expected 152, got %zu", result);
+
+	// Many concurrent coroutines awaiting each other
+	std::atomic_int completed = 0;
+	std::vector<job_system::JobPtr> launched;
+	for (int i = 0; i < 200; ++i)
+		launched.emplace_back(job_system::launch([](std::atomic_int& counter) -> job_system::Task<void>
+			{
+				co_await job_system::schedule_on(job_system::JobPriority::Critical);
+				if (co_await double_value(2) == 4)
+					++counter;
+			}(completed)));
+	for (const auto& job : launched)
+		job->wait();
+	if (completed != 200)
+		LOG_FATAL("coroutines : expected 200 completed tasks, got %d", completed.load());
+
+	// Short tasks : the waiting thread releases the job while the coroutine is still completing it
+	for (int i = 0; i < 5000; ++i)
+	{
+		if (job_system::sync_wait(double_value(i)) != i * 2)
+			LOG_FATAL("coroutines : wrong sync_wait result");
+		job_system::launch([]() -> job_system::Task<void> { co_await job_system::new_job([] {}); }())->wait();
+	}
+
+	LOG_VALIDATE("coroutines");
+}
+
+void test_fibers(int worker_count)
+{
+	// Few fibers : once they are all suspended, jobs fall back to running on the worker stacks
+	job_system::Worker::destroy_workers();
+	job_system::Worker::create_workers(job_system::WorkerSettings{.worker_count = worker_count, .use_fibers = true, .fiber_count = 16, .fiber_stack_size = 64 * 1024});
+
+	// Every job waits for its own child : each wait suspends the fiber instead of blocking the worker
+	std::atomic_int executed = 0;
+	job_system::new_job([&executed]
+		{
+			for (int i = 0; i < 1000; ++i)
+			{
+				job_system::new_job([&executed]
+					{
+						job_system::new_job([&executed] { ++executed; })->wait();
+						job_system::new_job([&executed] { ++executed; });
+						job_system::wait_children();
+						++executed;
+					});
+			}
+		})->wait();
+	if (executed != 3000)
+		LOG_FATAL("fibers : expected 3000 executed jobs, got %d", executed.load());
+
+	test_work_stealing();
+	test_parallel_for();
+	test_task_graph();
+	test_coroutines();
+	test_frame_profiler();
+	test_memory_tracking();
+	LOG_VALIDATE("fibers");
+}
+
 int main(int argc, char* argv[]) {
-	job_system::Worker::create_workers(1);
+	const int worker_count = argc > 1 ? std::atoi(argv[1]) : 1;
+	job_system::Worker::create_workers(worker_count);
+
+	test_work_stealing();
+	test_parallel_for();
+	test_task_graph();
+	test_job_priorities();
+	test_coroutines();
+	test_job_trace();
+	test_frame_profiler();
+	test_perf_counters();
+	test_telemetry();
+	test_mpmc_queue();
+	test_fast_mutex();
+	test_slot_map();
+	test_concurrent_ptr_map();
 
 
 	auto p2 = job_system::new_job([]
@@ -25,5 +700,9 @@ int main(int argc, char* argv[]) {
 	p2->wait();
 	LOG_VALIDATE("complete");
 
+	test_background_workers(worker_count);
+	test_pinned_workers(worker_count);
+	test_fibers(worker_count);
+
 	job_system::Worker::destroy_workers();
 }
@@ -0,0 +1,74 @@
+#include "benchmark.h"
+
+#include "jobSystem/job_system.h"
+#include "jobSystem/parallel_for.h"
+#include "types/concurrent_ptr_map.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Asset registry lookups : every worker resolves ids of a registry of ASSETS entries, as asset pointers do each frame.
+ * Compares the previous mutex guarded unordered_map against TConcurrentPtrMap, whose reads don't lock.
+ */
+
+namespace benchmark
+{
+
+static constexpr size_t ASSETS  = 4096;
+static constexpr size_t LOOKUPS = 1 << 21;
+
+struct RegistryEntry
+{
+    uint64_t value;
+};
+
+template <typename Lookup> double run_lookups(int worker_count, Lookup&& lookup)
+{
+    job_system::Worker::create_workers(worker_count);
+    const double elapsed = measure(
+        [&]
+        {
+            job_system::parallel_for<size_t>(0, LOOKUPS, 4096,
+                                             [&](size_t i)
+                                             {
+                                                 // Spread the ids without a modulo of the loop index
+                                                 const uint64_t id = (i * 2654435761u) % ASSETS;
+                                                 do_not_optimize(lookup(id)->value);
+                                             });
+        });
+    job_system::Worker::destroy_workers();
+    return elapsed;
+}
+
+void run_asset_registry_benchmark(const Settings& settings)
+{
+    std::vector<RegistryEntry>                   entries(ASSETS);
+    std::mutex                                   map_lock;
+    std::unordered_map<uint64_t, RegistryEntry*> locked_map;
+    TConcurrentPtrMap<RegistryEntry>             concurrent_map;
+    for (size_t i = 0; i < ASSETS; ++i)
+    {
+        entries[i].value = i;
+        locked_map.emplace(i, &entries[i]);
+        concurrent_map.try_insert(i, &entries[i]);
+    }
+
+    printf("\n== asset registry lookups (%zu assets, %zu lookups) ==\n", ASSETS, LOOKUPS);
+    printf("%8s | %22s | %22s | %8s\n", "workers", "mutex map (lookup/s)", "concurrent map (lookup/s)", "speedup");
+    for (int workers = 1; workers <= settings.max_workers; ++workers)
+    {
+        const double locked_time = run_lookups(workers,
+                                               [&](uint64_t id)
+                                               {
+                                                   std::lock_guard lock(map_lock);
+                                                   return locked_map.find(id)->second;
+                                               });
+        const double concurrent_time = run_lookups(workers, [&](uint64_t id) { return concurrent_map.find(id); });
+        const double lookups         = static_cast<double>(LOOKUPS);
+        printf("%8d | %22.0f | %25.0f | %7.2fx\n", workers, lookups / locked_time, lookups / concurrent_time, locked_time / concurrent_time);
+    }
+}
+
+} // namespace benchmark
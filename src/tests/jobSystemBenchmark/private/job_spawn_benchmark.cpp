@@ -0,0 +1,53 @@
+#include "benchmark.h"
+
+#include "jobSystem/job_system.h"
+
+/**
+ * Spawn + execute cost of trivial jobs : one root job spawns JOBS_PER_FRAME empty children, as a frame full of small jobs would.
+ */
+
+namespace benchmark
+{
+
+static constexpr uint32_t JOBS_PER_FRAME = 100000;
+static constexpr uint32_t FRAMES         = 20;
+
+void run_job_spawn_benchmark(const Settings& settings)
+{
+    printf("\n== job spawn + execute (%u jobs per frame, %u frames) ==\n", JOBS_PER_FRAME, FRAMES);
+    printf("%8s | %10s | %12s\n", "workers", "ns / job", "arena pages");
+    for (int workers = 1; workers <= settings.max_workers; ++workers)
+    {
+        job_system::Worker::create_workers(workers);
+
+        // Warm up : let the arenas reach their steady state size
+        job_system::new_job(
+            []
+            {
+                for (uint32_t i = 0; i < JOBS_PER_FRAME; ++i)
+                    job_system::new_job([] {});
+            })
+            ->wait();
+
+        const double elapsed = measure(
+            []
+            {
+                for (uint32_t frame = 0; frame < FRAMES; ++frame)
+                {
+                    job_system::begin_frame();
+                    job_system::new_job(
+                        []
+                        {
+                            for (uint32_t i = 0; i < JOBS_PER_FRAME; ++i)
+                                job_system::new_job([] {});
+                        })
+                        ->wait();
+                }
+            });
+        job_system::Worker::destroy_workers();
+
+        printf("%8d | %10.1f | %12zu\n", workers, elapsed * 1e9 / (static_cast<double>(JOBS_PER_FRAME) * FRAMES), job_system::JobArena::get_total_page_count());
+    }
+}
+
+} // namespace benchmark
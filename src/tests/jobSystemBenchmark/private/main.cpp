@@ -0,0 +1,20 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+/**
+ * usage : JobSystem_Benchmark [max_workers]
+ */
+int main(int argc, char* argv[])
+{
+    benchmark::Settings settings;
+    if (argc > 1)
+        settings.max_workers = std::max(1, std::atoi(argv[1]));
+
+    benchmark::run_work_stealing_benchmark(settings);
+    benchmark::run_job_spawn_benchmark(settings);
+    benchmark::run_mpmc_queue_benchmark(settings);
+    benchmark::run_slot_map_benchmark(settings);
+    benchmark::run_asset_registry_benchmark(settings);
+}
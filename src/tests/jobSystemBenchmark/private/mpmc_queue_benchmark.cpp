@@ -0,0 +1,100 @@
+#include "benchmark.h"
+
+#include "legacy_object_pool.h"
+#include "types/objectPool.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * Queue throughput : N producers push ITEMS objects in total while N consumers pop them, for N in [1, 64].
+ * Compares the previous mutex pool against TObjectPool (lock free shared_ptr queue) and TMpmcQueue storing plain values.
+ * Capacities hold every item : the legacy pool aborts on overflow, and the overflow segment of the lock free queues is not measured here.
+ */
+
+namespace benchmark
+{
+
+static constexpr size_t ITEMS         = 1 << 18;
+static constexpr int    MAX_THREADS   = 64;
+static constexpr size_t POOL_CAPACITY = ITEMS * 2;
+
+/** Run producer_count producers and consumers : push(i) for each item, then pop until every item was consumed */
+template <typename Push, typename Pop> double run_queue(int producer_count, Push&& push, Pop&& pop)
+{
+    std::atomic_size_t       consumed = 0;
+    std::atomic_bool         start    = false;
+    std::vector<std::thread> threads;
+    for (int producer = 0; producer < producer_count; ++producer)
+        threads.emplace_back(
+            [&, producer]
+            {
+                while (!start.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                for (size_t i = producer; i < ITEMS; i += producer_count)
+                    push(i);
+            });
+    for (int consumer = 0; consumer < producer_count; ++consumer)
+        threads.emplace_back(
+            [&]
+            {
+                while (!start.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                while (consumed.load(std::memory_order_relaxed) < ITEMS)
+                {
+                    if (pop())
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    else
+                        std::this_thread::yield();
+                }
+            });
+
+    return measure(
+        [&]
+        {
+            start.store(true, std::memory_order_release);
+            for (auto& thread : threads)
+                thread.join();
+        });
+}
+
+void run_mpmc_queue_benchmark(const Settings&)
+{
+    // Objects are allocated once : the benchmark measures the queues, not the allocator
+    std::vector<std::shared_ptr<size_t>> objects(ITEMS);
+    for (size_t i = 0; i < ITEMS; ++i)
+        objects[i] = std::make_shared<size_t>(i);
+
+    printf("\n== queue throughput (%zu items, N producers + N consumers) ==\n", ITEMS);
+    printf("%8s | %18s | %18s | %18s\n", "N", "mutex pool (op/s)", "TObjectPool (op/s)", "TMpmcQueue (op/s)");
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2)
+    {
+        double legacy_time, pool_time, queue_time;
+        {
+            auto pool   = std::make_unique<LegacyObjectPool<size_t, POOL_CAPACITY>>();
+            legacy_time = run_queue(
+                threads, [&](size_t i) { pool->push(objects[i]); }, [&] { return pool->pop() != nullptr; });
+        }
+        {
+            auto pool = std::make_unique<TObjectPool<size_t, POOL_CAPACITY>>();
+            pool_time = run_queue(
+                threads, [&](size_t i) { pool->push(objects[i]); }, [&] { return pool->pop() != nullptr; });
+        }
+        {
+            auto queue = std::make_unique<TMpmcQueue<size_t, POOL_CAPACITY>>();
+            queue_time = run_queue(
+                threads, [&](size_t i) { queue->push(i); },
+                [&]
+                {
+                    size_t value;
+                    return queue->pop(value);
+                });
+        }
+        const double items = static_cast<double>(ITEMS);
+        printf("%8d | %18.0f | %18.0f | %18.0f\n", threads, items / legacy_time, items / pool_time, items / queue_time);
+    }
+}
+
+} // namespace benchmark
@@ -0,0 +1,128 @@
+#include "benchmark.h"
+
+#include "types/slot_map.h"
+
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Handle to object mapping : TSlotMap against the unordered_map<handle, object> pattern it replaces (scene proxy, asset manager).
+ * Each test runs on OBJECTS objects of 64 bytes : insert all, look them up in random order, iterate, then erase them in random order.
+ */
+
+namespace benchmark
+{
+
+static constexpr size_t OBJECTS = 1 << 18;
+
+struct BenchmarkObject
+{
+    uint64_t values[8];
+};
+
+struct SlotMapTimes
+{
+    double insert;
+    double lookup;
+    double iterate;
+    double erase;
+};
+
+static SlotMapTimes run_slot_map(const std::vector<size_t>& order)
+{
+    TSlotMap<BenchmarkObject> objects;
+    std::vector<SlotHandle>   handles(OBJECTS);
+    SlotMapTimes              times;
+    times.insert = measure(
+        [&]
+        {
+            for (size_t i = 0; i < OBJECTS; ++i)
+                handles[i] = objects.insert(BenchmarkObject{{i}});
+        });
+    times.lookup = measure(
+        [&]
+        {
+            uint64_t sum = 0;
+            for (const size_t i : order)
+                sum += objects.get(handles[i])->values[0];
+            do_not_optimize(sum);
+        });
+    times.iterate = measure(
+        [&]
+        {
+            uint64_t sum = 0;
+            for (const BenchmarkObject& object : objects)
+                sum += object.values[0];
+            do_not_optimize(sum);
+        });
+    times.erase = measure(
+        [&]
+        {
+            for (const size_t i : order)
+                objects.erase(handles[i]);
+        });
+    return times;
+}
+
+static SlotMapTimes run_unordered_map(const std::vector<size_t>& order)
+{
+    std::unordered_map<uint64_t, BenchmarkObject> objects;
+    std::vector<uint64_t>                          handles(OBJECTS);
+    uint64_t                                       next_handle = 0;
+    SlotMapTimes                                   times;
+    times.insert = measure(
+        [&]
+        {
+            for (size_t i = 0; i < OBJECTS; ++i)
+            {
+                handles[i] = next_handle++;
+                objects.emplace(handles[i], BenchmarkObject{{i}});
+            }
+        });
+    times.lookup = measure(
+        [&]
+        {
+            uint64_t sum = 0;
+            for (const size_t i : order)
+                sum += objects.find(handles[i])->second.values[0];
+            do_not_optimize(sum);
+        });
+    times.iterate = measure(
+        [&]
+        {
+            uint64_t sum = 0;
+            for (const auto& object : objects)
+                sum += object.second.values[0];
+            do_not_optimize(sum);
+        });
+    times.erase = measure(
+        [&]
+        {
+            for (const size_t i : order)
+                objects.erase(handles[i]);
+        });
+    return times;
+}
+
+void run_slot_map_benchmark(const Settings&)
+{
+    std::vector<size_t> order(OBJECTS);
+    for (size_t i = 0; i < OBJECTS; ++i)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+
+    const SlotMapTimes slot_map      = run_slot_map(order);
+    const SlotMapTimes unordered_map = run_unordered_map(order);
+
+    const auto to_ns = [](double seconds) { return seconds * 1e9 / static_cast<double>(OBJECTS); };
+    printf("\n== handle map (%zu objects, ns / object) ==\n", OBJECTS);
+    printf("%10s | %14s | %14s | %8s\n", "operation", "TSlotMap", "unordered_map", "speedup");
+    printf("%10s | %14.1f | %14.1f | %7.2fx\n", "insert", to_ns(slot_map.insert), to_ns(unordered_map.insert), unordered_map.insert / slot_map.insert);
+    printf("%10s | %14.1f | %14.1f | %7.2fx\n", "lookup", to_ns(slot_map.lookup), to_ns(unordered_map.lookup), unordered_map.lookup / slot_map.lookup);
+    printf("%10s | %14.1f | %14.1f | %7.2fx\n", "iterate", to_ns(slot_map.iterate), to_ns(unordered_map.iterate), unordered_map.iterate / slot_map.iterate);
+    printf("%10s | %14.1f | %14.1f | %7.2fx\n", "erase", to_ns(slot_map.erase), to_ns(unordered_map.erase), unordered_map.erase / slot_map.erase);
+}
+
+} // namespace benchmark
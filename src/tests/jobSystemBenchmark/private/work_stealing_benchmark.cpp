@@ -0,0 +1,142 @@
+#include "benchmark.h"
+
+#include "jobSystem/job_system.h"
+#include "legacy_object_pool.h"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+/**
+ * Fork-join throughput : every job runs a small payload then spawns FANOUT children until DEPTH is reached.
+ * Compares the work-stealing job system against the previous design, where every job went through one mutex guarded object pool.
+ */
+
+namespace benchmark
+{
+
+static constexpr uint32_t FANOUT        = 4;
+static constexpr uint32_t DEPTH         = 6;
+static constexpr uint32_t PAYLOAD       = 200;
+static constexpr uint32_t ROUNDS        = 20;
+
+static constexpr size_t count_tree_jobs()
+{
+    size_t total = 0;
+    size_t level = 1;
+    for (uint32_t d = 0; d <= DEPTH; ++d, level *= FANOUT)
+        total += level;
+    return total;
+}
+static constexpr size_t JOBS_PER_TREE = count_tree_jobs();
+
+namespace legacy
+{
+// Minimal replica of the previous scheduler : a single shared mutex ring buffer feeding every thread
+struct LegacyTask
+{
+    std::function<void()> func;
+};
+
+class LegacyScheduler
+{
+  public:
+    explicit LegacyScheduler(int thread_count)
+    {
+        for (int i = 0; i < thread_count; ++i)
+            threads.emplace_back(
+                [this]
+                {
+                    while (run)
+                    {
+                        if (auto task = pool.pop())
+                            task->func();
+                        else
+                            std::this_thread::yield();
+                    }
+                });
+    }
+
+    ~LegacyScheduler()
+    {
+        run = false;
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    void push(std::function<void()> func)
+    {
+        pool.push(std::make_shared<LegacyTask>(LegacyTask{std::move(func)}));
+    }
+
+  private:
+    LegacyObjectPool<LegacyTask, 16384> pool;
+    std::vector<std::thread>            threads;
+    std::atomic_bool                    run = true;
+};
+
+void spawn_tree(LegacyScheduler& scheduler, std::atomic_size_t& completed, uint32_t depth)
+{
+    do_not_optimize(simulate_work(depth, PAYLOAD));
+    if (depth < DEPTH)
+        for (uint32_t i = 0; i < FANOUT; ++i)
+            scheduler.push([&scheduler, &completed, depth] { spawn_tree(scheduler, completed, depth + 1); });
+    completed.fetch_add(1, std::memory_order_release);
+}
+
+double run(int worker_count)
+{
+    LegacyScheduler scheduler(worker_count);
+    return measure(
+        [&]
+        {
+            for (uint32_t round = 0; round < ROUNDS; ++round)
+            {
+                std::atomic_size_t completed = 0;
+                scheduler.push([&] { spawn_tree(scheduler, completed, 0); });
+                while (completed.load(std::memory_order_acquire) != JOBS_PER_TREE)
+                    std::this_thread::yield();
+            }
+        });
+}
+} // namespace legacy
+
+namespace work_stealing
+{
+void spawn_tree(uint32_t depth)
+{
+    do_not_optimize(simulate_work(depth, PAYLOAD));
+    if (depth < DEPTH)
+        for (uint32_t i = 0; i < FANOUT; ++i)
+            job_system::new_job([depth] { spawn_tree(depth + 1); });
+}
+
+double run(int worker_count)
+{
+    job_system::Worker::create_workers(worker_count);
+    const double elapsed = measure(
+        []
+        {
+            for (uint32_t round = 0; round < ROUNDS; ++round)
+                job_system::new_job([] { spawn_tree(0); })->wait();
+        });
+    job_system::Worker::destroy_workers();
+    return elapsed;
+}
+} // namespace work_stealing
+
+void run_work_stealing_benchmark(const Settings& settings)
+{
+    const double total_jobs = static_cast<double>(JOBS_PER_TREE * ROUNDS);
+
+    printf("\n== fork-join throughput (%zu jobs per round, %u rounds) ==\n", JOBS_PER_TREE, ROUNDS);
+    printf("%8s | %18s | %18s | %8s\n", "workers", "mutex pool (job/s)", "work stealing (job/s)", "speedup");
+    for (int workers = 1; workers <= settings.max_workers; ++workers)
+    {
+        const double legacy_rate        = total_jobs / legacy::run(workers);
+        const double work_stealing_rate = total_jobs / work_stealing::run(workers);
+        printf("%8d | %18.0f | %21.0f | %7.2fx\n", workers, legacy_rate, work_stealing_rate, work_stealing_rate / legacy_rate);
+    }
+}
+
+} // namespace benchmark
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+namespace benchmark
+{
+
+struct Settings
+{
+    // Benchmarks are run for each worker count in [1, max_workers]
+    int max_workers = static_cast<int>(std::thread::hardware_concurrency());
+};
+
+/** Run the callback once and return the elapsed time in seconds */
+template <typename Lambda> double measure(Lambda&& callback)
+{
+    const auto start = std::chrono::steady_clock::now();
+    callback();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** Prevent the compiler from removing the computation producing value */
+template <typename Value_T> void do_not_optimize(const Value_T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    // The empty asm may read value through its address
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile Value_T sink;
+    sink = value;
+#endif
+}
+
+/** Small arithmetic payload standing for the body of a job */
+inline uint64_t simulate_work(uint64_t seed, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; ++i)
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return seed;
+}
+
+void run_work_stealing_benchmark(const Settings& settings);
+void run_job_spawn_benchmark(const Settings& settings);
+void run_mpmc_queue_benchmark(const Settings& settings);
+void run_slot_map_benchmark(const Settings& settings);
+void run_asset_registry_benchmark(const Settings& settings);
+
+} // namespace benchmark
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cpputils/logger.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace benchmark
+{
+/**
+ * Replica of the previous TObjectPool : a fixed capacity ring of shared_ptr guarded by a mutex, aborting on overflow.
+ * Kept as the baseline of the queue benchmarks.
+ */
+template <typename ObjectType, size_t PoolSize> class LegacyObjectPool
+{
+  public:
+    LegacyObjectPool()
+    {
+        pool.resize(PoolSize);
+    }
+
+    void push(std::shared_ptr<ObjectType> object)
+    {
+        std::lock_guard lock(pool_lock);
+        if ((pool_bottom + 1) % PoolSize == pool_top)
+        {
+            LOG_FATAL("object pool overflow : max=%zu", PoolSize);
+        }
+
+        pool[pool_bottom] = std::move(object);
+        pool_bottom       = (pool_bottom + 1) % PoolSize;
+    }
+
+    std::shared_ptr<ObjectType> pop()
+    {
+        std::lock_guard lock(pool_lock);
+        if (pool_top == pool_bottom)
+            return nullptr;
+
+        std::shared_ptr<ObjectType> object = std::move(pool[pool_top]);
+        pool_top                           = (pool_top + 1) % PoolSize;
+        return object;
+    }
+
+  private:
+    std::vector<std::shared_ptr<ObjectType>> pool;
+    std::mutex                               pool_lock;
+    size_t                                   pool_top    = 0;
+    size_t                                   pool_bottom = 0;
+};
+} // namespace benchmark
@@ -0,0 +1,125 @@
+#include "profiler_capture.h"
+
+#include <cpputils/logger.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+/**
+ * Convert a binary profiler capture (saved/profiler/Profiler-<date>.hecap) to CSV or Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+ * The output format is deduced from the output extension : .json for Chrome trace, CSV otherwise.
+ * Samples of scopes reading the hardware counters (BEGIN_COUNTED_RECORD) also get their IPC and cache / branch misses per thousand instructions.
+ */
+
+static std::string escape_json(const std::string& text)
+{
+	std::string escaped;
+	for (const char c : text)
+	{
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+		escaped += c;
+	}
+	return escaped;
+}
+
+struct CounterRates
+{
+	double ipc;
+	double cache_mpki; // cache misses per thousand instructions
+	double branch_mpki; // branch misses per thousand instructions
+};
+
+static CounterRates get_counter_rates(const profiler_capture::Sample& sample)
+{
+	using perf_counters::Counter;
+	const double cycles = static_cast<double>(sample.get_counter(Counter::Cycles));
+	const double instructions = static_cast<double>(sample.get_counter(Counter::Instructions));
+	if (instructions == 0.0)
+		return CounterRates{};
+	return CounterRates{
+		.ipc = cycles > 0.0 ? instructions / cycles : 0.0,
+		.cache_mpki = 1000.0 * static_cast<double>(sample.get_counter(Counter::CacheMisses)) / instructions,
+		.branch_mpki = 1000.0 * static_cast<double>(sample.get_counter(Counter::BranchMisses)) / instructions,
+	};
+}
+
+static void write_csv(profiler_capture::Reader& reader, std::ofstream& output, size_t& sample_count)
+{
+	output << "thread, name, function, start, duration, cycles, instructions, ipc, cache misses, branch misses, cache mpki, branch mpki" << std::endl;
+	profiler_capture::Sample sample;
+	while (reader.next(sample))
+	{
+		const profiler_capture::ScopeInfo& scope = reader.get_scope(sample.scope);
+		output << std::hex << reader.get_thread_hash(sample.thread) << std::dec << ", " << scope.name << ", " << scope.function_name << ", " << sample.start / 1000 << ", " << sample.duration / 1000;
+		if (sample.has_counters)
+		{
+			using perf_counters::Counter;
+			const CounterRates rates = get_counter_rates(sample);
+			output << ", " << sample.get_counter(Counter::Cycles) << ", " << sample.get_counter(Counter::Instructions) << ", " << rates.ipc << ", " << sample.get_counter(Counter::CacheMisses) << ", "
+			       << sample.get_counter(Counter::BranchMisses) << ", " << rates.cache_mpki << ", " << rates.branch_mpki;
+		}
+		else
+			output << ", , , , , , , ";
+		output << "\n";
+		++sample_count;
+	}
+}
+
+static void write_chrome_trace(profiler_capture::Reader& reader, std::ofstream& output, size_t& sample_count)
+{
+	output << "{\"traceEvents\":[\n";
+	output.precision(3);
+	output << std::fixed;
+	profiler_capture::Sample sample;
+	while (reader.next(sample))
+	{
+		const profiler_capture::ScopeInfo& scope = reader.get_scope(sample.scope);
+		const std::string&                 name  = scope.name.empty() ? scope.function_name : scope.name;
+		output << (sample_count ? ",\n" : "") << R"({"name":")" << escape_json(name) << R"(","cat":")" << escape_json(scope.function_name) << R"(","ph":"X","pid":1,"tid":)" << sample.thread
+		       << ",\"ts\":" << static_cast<double>(sample.start) / 1000.0 << ",\"dur\":" << static_cast<double>(sample.duration) / 1000.0 << R"(,"args":{"file":")" << escape_json(scope.file) << R"(","line":)"
+		       << scope.line;
+		if (sample.has_counters)
+		{
+			using perf_counters::Counter;
+			const CounterRates rates = get_counter_rates(sample);
+			output << ",\"cycles\":" << sample.get_counter(Counter::Cycles) << ",\"instructions\":" << sample.get_counter(Counter::Instructions) << ",\"ipc\":" << rates.ipc
+			       << ",\"cache_misses\":" << sample.get_counter(Counter::CacheMisses) << ",\"branch_misses\":" << sample.get_counter(Counter::BranchMisses) << ",\"cache_mpki\":" << rates.cache_mpki
+			       << ",\"branch_mpki\":" << rates.branch_mpki;
+		}
+		output << "}}";
+		++sample_count;
+	}
+	output << "\n]}\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3)
+	{
+		std::printf("usage : %s <capture.hecap> <output.csv|output.json>\n", argv[0]);
+		return 1;
+	}
+
+	profiler_capture::Reader reader;
+	if (!reader.open(argv[1]))
+		return 1;
+
+	const std::filesystem::path output_path = argv[2];
+	std::ofstream output(output_path);
+	if (!output)
+	{
+		LOG_ERROR("cannot write %s", output_path.string().c_str());
+		return 1;
+	}
+
+	size_t sample_count = 0;
+	if (output_path.extension() == ".json")
+		write_chrome_trace(reader, output, sample_count);
+	else
+		write_csv(reader, output, sample_count);
+
+	LOG_INFO("converted %zu samples to %s", sample_count, output_path.string().c_str());
+	return reader.is_corrupted() ? 1 : 0;
+}
@@ -0,0 +1,278 @@
+#include "frame_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+
+FrameProfiler frame_profiler_instance;
+
+namespace
+{
+// Parent node and scope id
+using NodeKey = uint64_t;
+
+NodeKey make_node_key(uint32_t parent, ProfilerScopeId scope)
+{
+    return static_cast<uint64_t>(parent) << 16 | scope;
+}
+} // namespace
+
+struct FrameProfiler::ThreadData
+{
+    // Only contended by end_frame()
+    FastMutex                lock;
+    std::vector<FrameSample> accumulators; // Indexed by node id
+
+    // Owner thread only
+    std::unordered_map<NodeKey, uint32_t> node_ids;
+    ScopeStack                            stack;
+};
+
+// There is a single frame profiler instance : scope stacks and thread data don't need to be looked up per profiler
+thread_local FrameProfiler::ScopeStack* current_scope_stack = nullptr;
+
+FrameProfiler& FrameProfiler::get()
+{
+    return frame_profiler_instance;
+}
+
+void FrameProfiler::set_enabled(bool in_enabled)
+{
+    std::lock_guard guard(lock);
+    if (in_enabled && !enabled)
+        last_frame_end = std::chrono::steady_clock::now();
+    enabled = in_enabled;
+}
+
+void FrameProfiler::set_history_size(size_t frame_count)
+{
+    std::lock_guard guard(lock);
+    history_size = std::max<size_t>(frame_count, 1);
+    clear_history();
+}
+
+void FrameProfiler::reset()
+{
+    std::lock_guard guard(lock);
+    clear_history();
+}
+
+void FrameProfiler::clear_history()
+{
+    for (Node& node : nodes)
+    {
+        node.history.assign(history_size, {});
+        node.history_head  = 0;
+        node.history_count = 0;
+        node.frame         = {};
+    }
+    frame_times.assign(history_size, Duration::zero());
+    frame_time_head  = 0;
+    frame_time_count = 0;
+    last_frame_end   = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::end_frame()
+{
+    if (!is_enabled())
+        return;
+
+    std::lock_guard guard(lock);
+
+    const auto now = std::chrono::steady_clock::now();
+    if (frame_times.empty())
+        frame_times.assign(history_size, Duration::zero());
+    frame_times[frame_time_head] = now - last_frame_end;
+    frame_time_head              = (frame_time_head + 1) % history_size;
+    frame_time_count             = std::min(frame_time_count + 1, history_size);
+    last_frame_end               = now;
+
+    for (const auto& data : thread_data)
+    {
+        std::lock_guard thread_guard(data->lock);
+        for (size_t i = 0; i < data->accumulators.size(); ++i)
+        {
+            FrameSample& sample = data->accumulators[i];
+            if (sample.calls == 0)
+                continue;
+            nodes[i].frame.inclusive += sample.inclusive;
+            nodes[i].frame.exclusive += sample.exclusive;
+            nodes[i].frame.calls += sample.calls;
+            sample = {};
+        }
+    }
+
+    // Frames a scope didn't run in are not kept : they would hide its cost in the percentiles
+    for (Node& node : nodes)
+    {
+        if (node.frame.calls == 0)
+            continue;
+        node.history[node.history_head] = node.frame;
+        node.history_head               = (node.history_head + 1) % history_size;
+        node.history_count              = std::min(node.history_count + 1, history_size);
+        node.frame                      = {};
+    }
+}
+
+std::vector<FrameProfiler::ScopeReport> FrameProfiler::get_report() const
+{
+    std::lock_guard          guard(lock);
+    std::vector<ScopeReport> reports;
+    reports.reserve(nodes.size());
+    // A node is always registered after its parent
+    for (uint32_t i = 0; i < nodes.size(); ++i)
+        reports.emplace_back(make_report(i));
+    return reports;
+}
+
+std::optional<FrameProfiler::ScopeReport> FrameProfiler::find_scope(std::string_view name) const
+{
+    std::lock_guard guard(lock);
+    for (uint32_t i = 0; i < nodes.size(); ++i)
+    {
+        const char* node_name = profiler_scope::get_display_name(profiler_scope::get(nodes[i].scope));
+        if (node_name && name == node_name)
+            return make_report(i);
+    }
+    return std::nullopt;
+}
+
+FrameProfiler::Percentiles FrameProfiler::get_frame_time() const
+{
+    std::lock_guard       guard(lock);
+    std::vector<Duration> samples(frame_times.begin(), frame_times.begin() + static_cast<std::ptrdiff_t>(frame_time_count));
+    return compute_percentiles(samples);
+}
+
+size_t FrameProfiler::get_frame_count() const
+{
+    std::lock_guard guard(lock);
+    return frame_time_count;
+}
+
+uint32_t FrameProfiler::begin_scope(ProfilerScopeId scope)
+{
+    if (!is_enabled())
+        return NO_SCOPE;
+
+    ThreadData& data  = get_thread_data();
+    ScopeStack& stack = current_scope_stack ? *current_scope_stack : data.stack;
+    if (stack.depth >= MAX_DEPTH)
+        return NO_SCOPE;
+
+    const uint32_t depth  = stack.depth;
+    const uint32_t parent = depth > 0 ? stack.nodes[depth - 1] : NO_PARENT;
+    const NodeKey  key    = make_node_key(parent, scope);
+    auto           found  = data.node_ids.find(key);
+    if (found == data.node_ids.end())
+        found = data.node_ids.emplace(key, register_node(parent, scope, depth)).first;
+
+    stack.nodes[depth]         = found->second;
+    stack.children_time[depth] = Duration::zero();
+    stack.depth                = depth + 1;
+    return depth;
+}
+
+void FrameProfiler::end_scope(uint32_t depth, Duration duration)
+{
+    if (depth == NO_SCOPE)
+        return;
+
+    ThreadData& data  = get_thread_data();
+    ScopeStack& stack = current_scope_stack ? *current_scope_stack : data.stack;
+    // Already closed by an outer scope that ended first
+    if (depth >= stack.depth)
+        return;
+
+    stack.depth       = depth;
+    const uint32_t id = stack.nodes[depth];
+    if (depth > 0)
+        stack.children_time[depth - 1] += duration;
+
+    std::lock_guard guard(data.lock);
+    if (data.accumulators.size() <= id)
+        data.accumulators.resize(id + 1);
+    FrameSample& sample = data.accumulators[id];
+    sample.inclusive += duration;
+    sample.exclusive += duration - stack.children_time[depth];
+    sample.calls++;
+}
+
+FrameProfiler::ScopeStack* FrameProfiler::swap_scope_stack(ScopeStack* stack)
+{
+    return std::exchange(current_scope_stack, stack);
+}
+
+FrameProfiler::ThreadData& FrameProfiler::get_thread_data()
+{
+    thread_local ThreadData* current_thread_data = nullptr;
+    if (!current_thread_data)
+    {
+        std::lock_guard guard(lock);
+        current_thread_data = thread_data.emplace_back(std::make_unique<ThreadData>()).get();
+    }
+    return *current_thread_data;
+}
+
+uint32_t FrameProfiler::register_node(uint32_t parent, ProfilerScopeId scope, uint32_t depth)
+{
+    std::lock_guard guard(lock);
+    // Another thread may already have met this scope
+    for (uint32_t i = 0; i < nodes.size(); ++i)
+        if (nodes[i].parent == parent && nodes[i].scope == scope)
+            return i;
+
+    Node& node  = nodes.emplace_back();
+    node.scope  = scope;
+    node.parent = parent;
+    node.depth  = depth;
+    node.history.resize(history_size);
+    return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+FrameProfiler::ScopeReport FrameProfiler::make_report(uint32_t id) const
+{
+    const Node&           node  = nodes[id];
+    const ProfilerScope&  scope = profiler_scope::get(node.scope);
+    std::vector<Duration> inclusive;
+    std::vector<Duration> exclusive;
+    inclusive.reserve(node.history_count);
+    exclusive.reserve(node.history_count);
+    for (size_t i = 0; i < node.history_count; ++i)
+    {
+        inclusive.emplace_back(node.history[i].inclusive);
+        exclusive.emplace_back(node.history[i].exclusive);
+    }
+
+    const FrameSample last = node.history_count > 0 ? node.history[(node.history_head + history_size - 1) % history_size] : FrameSample{};
+    return ScopeReport{
+        .id             = id,
+        .parent         = node.parent,
+        .depth          = node.depth,
+        .scope          = node.scope,
+        .name           = scope.name,
+        .function_name  = scope.function_name,
+        .frame_count    = node.history_count,
+        .last_inclusive = last.inclusive,
+        .last_exclusive = last.exclusive,
+        .last_calls     = last.calls,
+        .inclusive      = compute_percentiles(inclusive),
+        .exclusive      = compute_percentiles(exclusive),
+    };
+}
+
+FrameProfiler::Percentiles FrameProfiler::compute_percentiles(std::vector<Duration>& samples)
+{
+    if (samples.empty())
+        return {};
+    std::sort(samples.begin(), samples.end());
+    // Nearest rank
+    const auto rank = [&samples](double percentile) { return samples[static_cast<size_t>(std::ceil(percentile * static_cast<double>(samples.size()))) - 1]; };
+    return Percentiles{
+        .p50 = rank(0.50),
+        .p95 = rank(0.95),
+        .p99 = rank(0.99),
+        .max = samples.back(),
+    };
+}
@@ -0,0 +1,191 @@
+#include "memory_tracker.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+
+namespace memory
+{
+// Keeps the size and tag of an allocation in front of it. Its size preserves the malloc alignment
+struct alignas(alignof(std::max_align_t)) AllocationHeader
+{
+    size_t    size;
+    MemoryTag tag;
+};
+
+// One cache line per tag : subsystems allocating concurrently don't share counters
+struct alignas(64) TagCounters
+{
+    std::atomic_int64_t live_bytes        = 0;
+    std::atomic_int64_t peak_bytes        = 0;
+    std::atomic_int64_t live_allocations  = 0;
+    std::atomic_int64_t total_allocations = 0;
+};
+
+TagCounters                  tag_counters[static_cast<size_t>(MemoryTag::Count)];
+thread_local MemoryTag       current_tag = MemoryTag::Untagged;
+static constexpr const char* TAG_NAMES[] = {"untagged", "scene proxy", "assets", "shader buffers", "shader modules", "job system"};
+static_assert(std::size(TAG_NAMES) == static_cast<size_t>(MemoryTag::Count));
+
+void track_allocation(MemoryTag tag, size_t size)
+{
+    TagCounters&  counters   = tag_counters[static_cast<size_t>(tag)];
+    const int64_t live_bytes = counters.live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+    counters.live_allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.total_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    int64_t peak = counters.peak_bytes.load(std::memory_order_relaxed);
+    while (live_bytes > peak && !counters.peak_bytes.compare_exchange_weak(peak, live_bytes, std::memory_order_relaxed))
+    {
+    }
+}
+
+void track_free(MemoryTag tag, size_t size)
+{
+    TagCounters& counters = tag_counters[static_cast<size_t>(tag)];
+    counters.live_bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+    counters.live_allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void* malloc(size_t size, MemoryTag tag)
+{
+    auto* header = static_cast<AllocationHeader*>(std::malloc(sizeof(AllocationHeader) + size));
+    if (!header)
+        return nullptr;
+    header->size = size;
+    header->tag  = tag;
+    track_allocation(tag, size);
+    return header + 1;
+}
+
+void* realloc(void* ptr, size_t size, MemoryTag tag)
+{
+    if (!ptr)
+        return malloc(size, tag);
+    if (size == 0)
+    {
+        free(ptr);
+        return nullptr;
+    }
+
+    AllocationHeader* header        = static_cast<AllocationHeader*>(ptr) - 1;
+    const size_t      previous_size = header->size;
+    const MemoryTag   previous_tag  = header->tag;
+    auto*             new_header    = static_cast<AllocationHeader*>(std::realloc(header, sizeof(AllocationHeader) + size));
+    // On failure the original block is left untouched
+    if (!new_header)
+        return nullptr;
+
+    track_free(previous_tag, previous_size);
+    new_header->size = size;
+    new_header->tag  = tag;
+    track_allocation(tag, size);
+    return new_header + 1;
+}
+
+void free(void* ptr)
+{
+    if (!ptr)
+        return;
+    AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+    track_free(header->tag, header->size);
+    std::free(header);
+}
+
+TagStats get_stats(MemoryTag tag)
+{
+    const TagCounters& counters = tag_counters[static_cast<size_t>(tag)];
+    return TagStats{
+        .live_bytes        = counters.live_bytes.load(std::memory_order_relaxed),
+        .peak_bytes        = counters.peak_bytes.load(std::memory_order_relaxed),
+        .live_allocations  = counters.live_allocations.load(std::memory_order_relaxed),
+        .total_allocations = counters.total_allocations.load(std::memory_order_relaxed),
+    };
+}
+
+const char* get_tag_name(MemoryTag tag)
+{
+    return tag < MemoryTag::Count ? TAG_NAMES[static_cast<size_t>(tag)] : "invalid";
+}
+
+bool is_global_hook_enabled()
+{
+#if MEMORY_TRACK_GLOBAL_NEW
+    return true;
+#else
+    return false;
+#endif
+}
+
+MemoryTag get_current_tag()
+{
+    return current_tag;
+}
+
+TagScope::TagScope(MemoryTag tag) : previous_tag(current_tag)
+{
+    current_tag = tag;
+}
+
+TagScope::~TagScope()
+{
+    current_tag = previous_tag;
+}
+} // namespace memory
+
+#if MEMORY_TRACK_GLOBAL_NEW
+// Replaces the global operator new of the whole program (aligned versions excepted : they keep the default implementation)
+void* operator new(size_t size)
+{
+    if (void* ptr = memory::malloc(size, memory::current_tag))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return memory::malloc(size, memory::current_tag);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return memory::malloc(size, memory::current_tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    memory::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    memory::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    memory::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    memory::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    memory::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    memory::free(ptr);
+}
+#endif
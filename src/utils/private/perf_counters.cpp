@@ -0,0 +1,120 @@
+#include "perf_counters.h"
+
+#include <iterator>
+
+#if __linux__ && PROFILER_HARDWARE_COUNTERS
+#include <atomic>
+#include <cpputils/logger.hpp>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf_counters
+{
+	static constexpr const char* COUNTER_NAMES[] = {"cycles", "instructions", "cache misses", "branch misses"};
+	static_assert(std::size(COUNTER_NAMES) == COUNTER_COUNT);
+
+#if __linux__ && PROFILER_HARDWARE_COUNTERS
+	static constexpr uint64_t COUNTER_CONFIGS[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+	static_assert(std::size(COUNTER_CONFIGS) == COUNTER_COUNT);
+
+	// All the counters of a thread are in one group, led by the first one : they are scheduled together and read with a single syscall
+	struct ThreadCounters
+	{
+		~ThreadCounters()
+		{
+			for (const int fd : fds)
+				if (fd >= 0)
+					close(fd);
+		}
+
+		int fds[COUNTER_COUNT] = {-1, -1, -1, -1};
+		uint32_t thread_group = 0; // Unique per thread : fd numbers are reused once a thread exits
+		bool initialized = false;
+		bool available = false;
+	};
+
+	static int open_counter(uint64_t config, int group_fd)
+	{
+		perf_event_attr attributes{};
+		attributes.size = sizeof(attributes);
+		attributes.type = PERF_TYPE_HARDWARE;
+		attributes.config = config;
+		attributes.read_format = PERF_FORMAT_GROUP;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		// The group is enabled at once when complete
+		attributes.disabled = group_fd < 0 ? 1 : 0;
+		// Calling thread, on any cpu
+		return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group_fd, 0));
+	}
+
+	static ThreadCounters& get_thread_counters()
+	{
+		thread_local ThreadCounters counters;
+		if (!counters.initialized)
+		{
+			counters.initialized = true;
+			for (size_t i = 0; i < COUNTER_COUNT; ++i)
+			{
+				counters.fds[i] = open_counter(COUNTER_CONFIGS[i], counters.fds[0]);
+				if (counters.fds[i] < 0)
+				{
+					static std::atomic_bool warned = false;
+					if (!warned.exchange(true))
+					{
+						LOG_WARNING("hardware performance counters are not available (perf_event_open failed for %s)", COUNTER_NAMES[i]);
+					}
+					return counters;
+				}
+			}
+			counters.available = ioctl(counters.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == 0;
+			static std::atomic_uint32_t last_thread_group = 0;
+			counters.thread_group = last_thread_group.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+		return counters;
+	}
+
+	bool read(Sample& sample)
+	{
+		const ThreadCounters& counters = get_thread_counters();
+		if (!counters.available)
+			return false;
+
+		struct
+		{
+			uint64_t count;
+			uint64_t values[COUNTER_COUNT];
+		} group;
+		if (::read(counters.fds[0], &group, sizeof(group)) != sizeof(group) || group.count != COUNTER_COUNT)
+			return false;
+
+		for (size_t i = 0; i < COUNTER_COUNT; ++i)
+			sample.values[i] = group.values[i];
+		sample.group = counters.thread_group;
+		return true;
+	}
+
+	bool is_available()
+	{
+		return get_thread_counters().available;
+	}
+#else
+	bool read(Sample&)
+	{
+		return false;
+	}
+
+	bool is_available()
+	{
+		return false;
+	}
+#endif
+
+	const char* get_counter_name(Counter counter)
+	{
+		return counter < Counter::Count ? COUNTER_NAMES[static_cast<size_t>(counter)] : "invalid";
+	}
+}
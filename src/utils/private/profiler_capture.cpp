@@ -0,0 +1,256 @@
+#include "profiler_capture.h"
+
+#include <cpputils/logger.hpp>
+#include <cstring>
+
+namespace profiler_capture
+{
+// Pending bytes written at once
+static constexpr size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+static void write_varint(std::vector<uint8_t>& buffer, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		buffer.emplace_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	buffer.emplace_back(static_cast<uint8_t>(value));
+}
+
+static uint64_t zigzag_encode(int64_t value)
+{
+	return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t zigzag_decode(uint64_t value)
+{
+	return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+Writer::~Writer()
+{
+	close();
+}
+
+bool Writer::open(const std::filesystem::path& path)
+{
+	close();
+	output.open(path, std::ios::binary);
+	if (!output)
+	{
+		LOG_ERROR("cannot write profiler capture to %s", path.string().c_str());
+		return false;
+	}
+	written_scopes.assign(profiler_scope::MAX_SCOPES, false);
+	thread_ids.clear();
+	last_start = 0;
+	buffer.reserve(WRITE_BUFFER_SIZE + 1024);
+	output.write(MAGIC, sizeof(MAGIC));
+	const uint32_t version = VERSION;
+	output.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	return true;
+}
+
+void Writer::close()
+{
+	if (!output.is_open()) return;
+	flush();
+	output.close();
+}
+
+void Writer::write(const ProfilerScope& scope, std::thread::id thread, int64_t start, uint64_t duration, const uint64_t* counters)
+{
+	if (!output.is_open()) return;
+
+	const uint32_t thread_id = get_thread_id(thread);
+	if (!written_scopes[scope.id])
+		write_scope(scope);
+
+	buffer.emplace_back(static_cast<uint8_t>(counters ? RecordType::CountedStat : RecordType::Stat));
+	write_varint(buffer, thread_id);
+	write_varint(buffer, scope.id);
+	// Stats are collected thread after thread : the delta is small but can be negative
+	write_varint(buffer, zigzag_encode(start - last_start));
+	write_varint(buffer, duration);
+	if (counters)
+		for (size_t i = 0; i < perf_counters::COUNTER_COUNT; ++i)
+			write_varint(buffer, counters[i]);
+	last_start = start;
+
+	if (buffer.size() >= WRITE_BUFFER_SIZE)
+		flush();
+}
+
+void Writer::write_scope(const ProfilerScope& scope)
+{
+	written_scopes[scope.id] = true;
+	buffer.emplace_back(static_cast<uint8_t>(RecordType::Scope));
+	write_varint(buffer, scope.id);
+	write_string(scope.name);
+	write_string(scope.function_name);
+	write_string(scope.file);
+	write_varint(buffer, scope.line);
+	for (size_t i = 0; i < sizeof(scope.color); ++i)
+		buffer.emplace_back(static_cast<uint8_t>(scope.color >> (i * 8)));
+}
+
+void Writer::write_string(const char* string)
+{
+	const size_t length = string ? strlen(string) : 0;
+	write_varint(buffer, length);
+	buffer.insert(buffer.end(), string, string + length);
+}
+
+uint32_t Writer::get_thread_id(std::thread::id thread)
+{
+	if (const auto found = thread_ids.find(thread); found != thread_ids.end())
+		return found->second;
+
+	const uint32_t id = static_cast<uint32_t>(thread_ids.size());
+	thread_ids.emplace(thread, id);
+	const uint64_t hash = std::hash<std::thread::id>()(thread);
+	buffer.emplace_back(static_cast<uint8_t>(RecordType::Thread));
+	write_varint(buffer, id);
+	for (size_t i = 0; i < sizeof(hash); ++i)
+		buffer.emplace_back(static_cast<uint8_t>(hash >> (i * 8)));
+	return id;
+}
+
+void Writer::flush()
+{
+	output.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+	buffer.clear();
+}
+
+bool Reader::open(const std::filesystem::path& path)
+{
+	input.open(path, std::ios::binary);
+	if (!input)
+	{
+		LOG_ERROR("cannot open profiler capture %s", path.string().c_str());
+		return false;
+	}
+	char     magic[sizeof(MAGIC)];
+	uint32_t version = 0;
+	input.read(magic, sizeof(magic));
+	input.read(reinterpret_cast<char*>(&version), sizeof(version));
+	if (!input || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+	{
+		LOG_ERROR("%s is not a profiler capture", path.string().c_str());
+		return false;
+	}
+	if (version != VERSION)
+	{
+		LOG_ERROR("unsupported profiler capture version %u (expected %u)", version, VERSION);
+		return false;
+	}
+	return true;
+}
+
+bool Reader::next(Sample& sample)
+{
+	while (true)
+	{
+		const int type = input.get();
+		if (type == std::char_traits<char>::eof())
+			return false;
+
+		uint64_t id = 0;
+		switch (static_cast<RecordType>(type))
+		{
+		case RecordType::Scope:
+		{
+			ScopeInfo scope;
+			uint64_t  line = 0;
+			uint8_t   color[sizeof(uint32_t)];
+			if (!read_varint(id) || id >= profiler_scope::MAX_SCOPES || !read_string(scope.name) || !read_string(scope.function_name) || !read_string(scope.file) || !read_varint(line) ||
+			    !input.read(reinterpret_cast<char*>(color), sizeof(color)))
+				break;
+			scope.line = static_cast<uint32_t>(line);
+			for (size_t i = 0; i < sizeof(color); ++i)
+				scope.color |= static_cast<uint32_t>(color[i]) << (i * 8);
+			if (scopes.size() <= id)
+				scopes.resize(id + 1);
+			scopes[id] = std::move(scope);
+			continue;
+		}
+		case RecordType::Thread:
+		{
+			uint8_t hash[sizeof(uint64_t)];
+			if (!read_varint(id) || id != threads.size() || !input.read(reinterpret_cast<char*>(hash), sizeof(hash)))
+				break;
+			uint64_t value = 0;
+			for (size_t i = 0; i < sizeof(hash); ++i)
+				value |= static_cast<uint64_t>(hash[i]) << (i * 8);
+			threads.emplace_back(value);
+			continue;
+		}
+		case RecordType::Stat:
+		case RecordType::CountedStat:
+		{
+			uint64_t thread, scope, start_delta, duration;
+			if (!read_varint(thread) || !read_varint(scope) || !read_varint(start_delta) || !read_varint(duration))
+				break;
+			if (thread >= threads.size() || scope >= scopes.size())
+				break;
+			last_start += zigzag_decode(start_delta);
+			sample = Sample{
+				.thread = static_cast<uint32_t>(thread),
+				.scope = static_cast<ProfilerScopeId>(scope),
+				.start = last_start,
+				.duration = duration,
+			};
+			if (static_cast<RecordType>(type) == RecordType::CountedStat)
+			{
+				sample.has_counters = true;
+				bool valid = true;
+				for (uint64_t& counter : sample.counters)
+					valid = valid && read_varint(counter);
+				if (!valid)
+					break;
+			}
+			return true;
+		}
+		}
+		corrupted = true;
+		LOG_ERROR("corrupted profiler capture");
+		return false;
+	}
+}
+
+const ScopeInfo& Reader::get_scope(ProfilerScopeId id) const
+{
+	return scopes[id];
+}
+
+uint64_t Reader::get_thread_hash(uint32_t id) const
+{
+	return threads[id];
+}
+
+bool Reader::read_string(std::string& string)
+{
+	uint64_t length = 0;
+	if (!read_varint(length))
+		return false;
+	string.assign(length, '\0');
+	return static_cast<bool>(input.read(string.data(), static_cast<std::streamsize>(length)));
+}
+
+bool Reader::read_varint(uint64_t& value)
+{
+	value = 0;
+	for (uint32_t shift = 0; shift < 64; shift += 7)
+	{
+		const int byte = input.get();
+		if (byte == std::char_traits<char>::eof())
+			return false;
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+} // namespace profiler_capture
@@ -0,0 +1,54 @@
+#include "profiler_scope.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <cpputils/logger.hpp>
+
+namespace profiler_scope
+{
+	// Scopes are stored in fixed size chunks : a registered scope never moves, so readers don't need the lock
+	static constexpr size_t CHUNK_SIZE = 256;
+
+	std::mutex registry_lock;
+	std::unique_ptr<ProfilerScope[]> chunks[MAX_SCOPES / CHUNK_SIZE];
+	std::atomic_size_t scope_count = 0;
+
+	const ProfilerScope& register_scope(const char* name, const char* function_name, const char* file, uint32_t line, uint32_t color, bool read_counters)
+	{
+		std::lock_guard lock(registry_lock);
+		const size_t id = scope_count.load(std::memory_order_relaxed);
+		if (id >= MAX_SCOPES)
+		{
+			LOG_FATAL("too many profiler scopes (max=%zu)", MAX_SCOPES);
+		}
+
+		std::unique_ptr<ProfilerScope[]>& chunk = chunks[id / CHUNK_SIZE];
+		if (!chunk)
+			chunk = std::make_unique<ProfilerScope[]>(CHUNK_SIZE);
+
+		ProfilerScope& scope = chunk[id % CHUNK_SIZE];
+		scope = ProfilerScope{
+			.name = name,
+			.function_name = function_name,
+			.file = file,
+			.line = line,
+			.color = color,
+			.id = static_cast<ProfilerScopeId>(id),
+			.read_counters = read_counters,
+		};
+		scope_count.store(id + 1, std::memory_order_release);
+		return scope;
+	}
+
+	const ProfilerScope& get(ProfilerScopeId id)
+	{
+		return chunks[id / CHUNK_SIZE][id % CHUNK_SIZE];
+	}
+
+	size_t get_count()
+	{
+		return scope_count.load(std::memory_order_acquire);
+	}
+}
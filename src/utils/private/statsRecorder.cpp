@@ -2,15 +2,14 @@
 #include "statsRecorder.h"
 
 
+#include <algorithm>
 #include <filesystem>
-#include <fstream>
-#include <iostream>
 
 
 
 #include "config.h"
+#include "telemetry.h"
 #include <cpputils/logger.hpp>
-#include <cpputils/stringutils.hpp>
 
 #if _DEBUG
 Profiler profiler_instance(true);
@@ -18,11 +17,15 @@ Profiler profiler_instance(true);
 Profiler profiler_instance(false);
 #endif
 
-StatRecorder::StatRecorder(const char* name, const char* function_name, bool auto_close)
-	: recorder_name(name), recorder_function_name(function_name), has_ended(false), thread_id(std::this_thread::get_id())
+// Delay between two collections. A thread must record less than STATS_PER_THREAD stats during this period.
+static constexpr std::chrono::milliseconds COLLECT_PERIOD(1);
+
+StatRecorder::StatRecorder(const ProfilerScope& scope)
+	: frame_scope(FrameProfiler::get().begin_scope(scope.id)), scope_id(scope.id), has_counters(false), has_ended(false)
 {
+	if (scope.read_counters && Profiler::get().is_profiler_recording())
+		has_counters = perf_counters::read(start_counters);
 	start_time = record_clock::now();
-	if (auto_close) end();
 }
 
 StatRecorder::~StatRecorder()
@@ -35,12 +38,43 @@ void StatRecorder::end()
 	if (has_ended) return;
 	has_ended = true;
 
-	Profiler::get().push_stat(Profiler::Stat {
-		.name = recorder_name,
-		.function_name = recorder_function_name,
+	const record_clock::duration duration = record_clock::now() - start_time;
+	FrameProfiler::get().end_scope(frame_scope, duration);
+	if (telemetry::is_enabled())
+		telemetry::record(scope_id, std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+
+	Profiler& profiler = Profiler::get();
+	if (!profiler.is_profiler_recording()) return;
+	const Profiler::Stat stat {
 		.date = start_time,
-		.duration = record_clock::now() - start_time,
-		.thread = thread_id,
+		.duration = duration,
+		.scope = scope_id,
+		.thread = 0,
+	};
+
+	// A fiber can resume on another thread : counters read by different threads are discarded
+	perf_counters::Sample end_counters;
+	if (has_counters && perf_counters::read(end_counters) && end_counters.group == start_counters.group)
+	{
+		Profiler::CountedStat counted_stat{.stat = stat, .counters = {}};
+		for (size_t i = 0; i < perf_counters::COUNTER_COUNT; ++i)
+			counted_stat.counters[i] = end_counters.values[i] - start_counters.values[i];
+		profiler.push_counted_stat(counted_stat);
+	}
+	else
+		profiler.push_stat(stat);
+}
+
+void StatRecorder::add_timepoint(const ProfilerScope& scope)
+{
+	// Timepoints have no duration : they are not part of the frame scopes
+	Profiler& profiler = Profiler::get();
+	if (!profiler.is_profiler_recording()) return;
+	profiler.push_stat(Profiler::Stat {
+		.date = record_clock::now(),
+		.duration = record_clock::duration::zero(),
+		.scope = scope.id,
+		.thread = 0,
 	});
 }
 
@@ -63,29 +97,142 @@ Profiler& Profiler::get()
 void Profiler::begin_record(bool silent)
 {
 	if (is_recording) return;
-	std::lock_guard<std::mutex> lock(access_lock);
-        if (!silent) LOG_INFO("begin profiler record");
-	is_recording = true;
-	record_start = record_clock::now();
+	{
+		std::lock_guard<std::mutex> lock(access_lock);
+		if (!silent) LOG_INFO("begin profiler record");
+		// Discard stats pushed by threads that were still running a scope when the previous record ended
+		collect_stats();
+		history.clear();
+		history_next = 0;
+		for (const auto& buffer : thread_buffers)
+			buffer->dropped.store(0, std::memory_order_relaxed);
+		open_capture();
+		record_start = record_clock::now();
+		is_recording = true;
+	}
+	collector_thread = std::thread(&Profiler::collector_main, this);
 }
 
 void Profiler::end_record()
 {
 	if (!is_recording) return;
-	std::lock_guard<std::mutex> lock(access_lock);
-        LOG_INFO("storing profiler stats");
 	is_recording = false;
-	store_stats();
+	if (collector_thread.joinable())
+		collector_thread.join();
+
+	std::lock_guard<std::mutex> lock(access_lock);
+	collect_stats();
+	last_dropped_stats = 0;
+	for (const auto& buffer : thread_buffers)
+		last_dropped_stats += buffer->dropped.load(std::memory_order_relaxed);
+	if (last_dropped_stats > 0)
+		LOG_WARNING("profiler : %zu stats were dropped (thread buffers full)", last_dropped_stats);
+	if (capture.is_open())
+	{
+		capture.close();
+		LOG_INFO("profiler capture saved to %s", last_capture_path.string().c_str());
+	}
+	// Once the ring is full, history_next is the oldest stat
+	if (history.size() == HISTORY_SIZE)
+		std::rotate(history.begin(), history.begin() + static_cast<std::ptrdiff_t>(history_next), history.end());
+	last_result = std::move(history);
+	history.clear();
+	history_next = 0;
 }
 
-void Profiler::push_stat(Stat stat)
+void Profiler::push_stat(const Stat& stat)
+{
+	ThreadBuffer& buffer = get_thread_buffer();
+	if (!buffer.stats.push(stat))
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Profiler::push_counted_stat(const CountedStat& stat)
+{
+	ThreadBuffer& buffer = get_thread_buffer();
+	if (!buffer.counted_stats.push(stat))
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+Profiler::ThreadBuffer& Profiler::get_thread_buffer()
+{
+	// Gives the buffer back when the thread exits : short lived threads (asset loaders, std::async) reuse the buffers of exited ones
+	struct ThreadBufferOwner
+	{
+		~ThreadBufferOwner()
+		{
+			if (buffer)
+				Profiler::get().release_thread_buffer(*buffer);
+		}
+
+		ThreadBuffer* buffer = nullptr;
+	};
+
+	// There is a single profiler instance, so the buffer doesn't need to be looked up per profiler. Only the first stat of each thread takes the lock.
+	thread_local ThreadBufferOwner owner;
+	if (!owner.buffer)
+	{
+		std::lock_guard<std::mutex> lock(access_lock);
+		if (!free_thread_buffers.empty())
+		{
+			owner.buffer = free_thread_buffers.back();
+			free_thread_buffers.pop_back();
+		}
+		else
+		{
+			owner.buffer = thread_buffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+			owner.buffer->index = static_cast<uint32_t>(thread_buffers.size() - 1);
+		}
+		owner.buffer->thread = std::this_thread::get_id();
+	}
+	return *owner.buffer;
+}
+
+void Profiler::release_thread_buffer(ThreadBuffer& buffer)
+{
+	std::lock_guard<std::mutex> lock(access_lock);
+	// The stats of the exiting thread are drained before another thread pushes into the buffer
+	collect_buffer(buffer);
+	free_thread_buffers.emplace_back(&buffer);
+}
+
+void Profiler::collect_stats()
+{
+	for (const auto& buffer : thread_buffers)
+		collect_buffer(*buffer);
+}
+
+void Profiler::collect_buffer(ThreadBuffer& buffer)
+{
+	const auto collect = [this, &buffer](const Stat& stat, const uint64_t* counters)
+	{
+		Stat& collected = history.size() < HISTORY_SIZE ? history.emplace_back(stat) : (history[history_next] = stat);
+		history_next = (history_next + 1) % HISTORY_SIZE;
+		collected.thread = buffer.index;
+		capture.write(profiler_scope::get(stat.scope), buffer.thread, std::chrono::duration_cast<std::chrono::nanoseconds>(stat.date - profiler_creation_time).count(),
+		              std::chrono::duration_cast<std::chrono::nanoseconds>(stat.duration).count(), counters);
+	};
+	buffer.stats.consume_all([&collect](const Stat& stat) { collect(stat, nullptr); });
+	buffer.counted_stats.consume_all([&collect](const CountedStat& stat) { collect(stat.stat, stat.counters); });
+}
+
+std::thread::id Profiler::get_thread_id(uint32_t thread) const
 {
-	if (!is_recording) return;
 	std::lock_guard<std::mutex> lock(access_lock);
-	history.push_front(stat);
+	return thread < thread_buffers.size() ? thread_buffers[thread]->thread : std::thread::id();
 }
 
-void Profiler::store_stats()
+void Profiler::collector_main()
+{
+	while (is_recording)
+	{
+		std::this_thread::sleep_for(COLLECT_PERIOD);
+		std::lock_guard<std::mutex> lock(access_lock);
+		collect_stats();
+	}
+}
+
+void Profiler::open_capture()
 {
 	/**
 	 * get time string
@@ -102,28 +249,8 @@ void Profiler::store_stats()
 
 
 	std::filesystem::create_directories(config::profiler_storage_path);
-	
-	
-	std::ofstream output(std::string(config::profiler_storage_path) + "/Profiler-" + buf + ".csv");
-	if (!output)
-	{ LOG_FATAL("cannot write profiler results ");
-	}
 
-	
-	output << "thread, name, function, start, end" << std::endl;
-	
-	for (const auto& stat : history)
-	{
-		output << stringutils::format("%x, %s, %s, %ld, %ld",
-			stat.thread,
-			stat.name,
-			stat.function_name,
-			std::chrono::duration_cast<std::chrono::microseconds>(stat.date - profiler_creation_time).count(),
-			std::chrono::duration_cast<std::chrono::microseconds>(stat.duration).count()
-			) << std::endl;
-	}
-	
-	output.close();
-	last_result = history;
-	history.clear();
+	// Stats are streamed to the capture by the collector : convert it with ProfilerConverter
+	last_capture_path = std::filesystem::path(config::profiler_storage_path) / (std::string("Profiler-") + buf + ".hecap");
+	capture.open(last_capture_path);
 }
@@ -0,0 +1,247 @@
+#include "telemetry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <csignal>
+#include <ctime>
+#include <fstream>
+#include <memory>
+
+#include <cpputils/logger.hpp>
+
+namespace telemetry
+{
+// Cache line aligned : histograms of different shards never share a line
+struct alignas(64) ScopeHistogram
+{
+    std::atomic_uint64_t calls    = 0;
+    std::atomic_uint64_t total_ns = 0;
+    std::atomic_uint64_t max_ns   = 0;
+    std::atomic_uint32_t buckets[BUCKET_COUNT];
+};
+
+// Threads record into their own shard, so scopes completed by every worker don't bounce the same counters between cores. Shards are merged by get_stats().
+// Histograms are allocated the first time their scope completes in a shard, and never freed : pointers stay valid for lock free readers
+static constexpr size_t                    SHARD_COUNT = 16;
+static constexpr size_t                    CHUNK_SIZE  = 256;
+std::atomic<std::atomic<ScopeHistogram*>*> chunks[SHARD_COUNT][profiler_scope::MAX_SCOPES / CHUNK_SIZE];
+std::atomic_size_t                         next_shard        = 0;
+std::atomic_bool                           telemetry_enabled = false;
+volatile std::sig_atomic_t                 dump_requested    = 0;
+
+static size_t get_thread_shard()
+{
+    // Round robin : up to SHARD_COUNT threads never share a shard
+    thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+    return shard;
+}
+
+static ScopeHistogram& get_histogram(size_t shard, ProfilerScopeId scope)
+{
+    std::atomic<std::atomic<ScopeHistogram*>*>& chunk_slot = chunks[shard][scope / CHUNK_SIZE];
+    std::atomic<ScopeHistogram*>*               chunk      = chunk_slot.load(std::memory_order_acquire);
+    if (!chunk)
+    {
+        auto* new_chunk = new std::atomic<ScopeHistogram*>[CHUNK_SIZE]();
+        if (chunk_slot.compare_exchange_strong(chunk, new_chunk, std::memory_order_acq_rel))
+            chunk = new_chunk;
+        else
+            delete[] new_chunk;
+    }
+
+    std::atomic<ScopeHistogram*>& histogram_slot = chunk[scope % CHUNK_SIZE];
+    ScopeHistogram*               histogram      = histogram_slot.load(std::memory_order_acquire);
+    if (!histogram)
+    {
+        auto* new_histogram = new ScopeHistogram();
+        if (histogram_slot.compare_exchange_strong(histogram, new_histogram, std::memory_order_acq_rel))
+            histogram = new_histogram;
+        else
+            delete new_histogram;
+    }
+    return *histogram;
+}
+
+static ScopeHistogram* find_histogram(size_t shard, size_t scope)
+{
+    const std::atomic<ScopeHistogram*>* chunk = chunks[shard][scope / CHUNK_SIZE].load(std::memory_order_acquire);
+    return chunk ? chunk[scope % CHUNK_SIZE].load(std::memory_order_acquire) : nullptr;
+}
+
+void set_enabled(bool enabled)
+{
+    telemetry_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool is_enabled()
+{
+    return telemetry_enabled.load(std::memory_order_relaxed);
+}
+
+size_t get_bucket(uint64_t duration_ns)
+{
+    if (duration_ns < SUB_BUCKET_COUNT)
+        return duration_ns;
+    const uint32_t magnitude = static_cast<uint32_t>(std::bit_width(duration_ns)) - 1;
+    if (magnitude >= MAX_DURATION_BITS)
+        return BUCKET_COUNT - 1;
+    // The SUB_BUCKET_BITS bits below the highest one select the sub bucket
+    const uint32_t shift = magnitude - SUB_BUCKET_BITS;
+    return SUB_BUCKET_COUNT * (shift + 1) + ((duration_ns >> shift) - SUB_BUCKET_COUNT);
+}
+
+uint64_t get_bucket_max(size_t bucket)
+{
+    if (bucket < SUB_BUCKET_COUNT)
+        return bucket;
+    const uint64_t shift      = bucket / SUB_BUCKET_COUNT - 1;
+    const uint64_t sub_bucket = bucket % SUB_BUCKET_COUNT;
+    return ((SUB_BUCKET_COUNT + sub_bucket + 1) << shift) - 1;
+}
+
+void record(ProfilerScopeId scope, uint64_t duration_ns)
+{
+    ScopeHistogram& histogram = get_histogram(get_thread_shard(), scope);
+    histogram.calls.fetch_add(1, std::memory_order_relaxed);
+    histogram.total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+    histogram.buckets[get_bucket(duration_ns)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = histogram.max_ns.load(std::memory_order_relaxed);
+    while (duration_ns > max && !histogram.max_ns.compare_exchange_weak(max, duration_ns, std::memory_order_relaxed))
+    {
+    }
+}
+
+std::vector<ScopeStats> get_stats()
+{
+    std::vector<ScopeStats> stats;
+    const size_t            scope_count = profiler_scope::get_count();
+    uint64_t                buckets[BUCKET_COUNT];
+    for (size_t scope = 0; scope < scope_count; ++scope)
+    {
+        // Merge the shards, snapshotting the buckets : percentiles are computed on their own total, which may differ slightly from calls under concurrent records
+        ScopeStats merged{.scope = static_cast<ProfilerScopeId>(scope)};
+        uint64_t   count = 0;
+        std::fill(std::begin(buckets), std::end(buckets), 0);
+        for (size_t shard = 0; shard < SHARD_COUNT; ++shard)
+        {
+            const ScopeHistogram* histogram = find_histogram(shard, scope);
+            if (!histogram)
+                continue;
+            for (size_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                const uint32_t bucket_count = histogram->buckets[i].load(std::memory_order_relaxed);
+                buckets[i] += bucket_count;
+                count += bucket_count;
+            }
+            merged.calls += histogram->calls.load(std::memory_order_relaxed);
+            merged.total_ns += histogram->total_ns.load(std::memory_order_relaxed);
+            merged.max_ns = std::max(merged.max_ns, histogram->max_ns.load(std::memory_order_relaxed));
+        }
+        if (count == 0)
+            continue;
+
+        ScopeStats& scope_stats = stats.emplace_back(merged);
+
+        const auto percentile = [&](double ratio)
+        {
+            const uint64_t rank       = static_cast<uint64_t>(ratio * static_cast<double>(count - 1)) + 1;
+            uint64_t       cumulative = 0;
+            for (size_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                cumulative += buckets[i];
+                if (cumulative >= rank)
+                    return std::min(get_bucket_max(i), scope_stats.max_ns);
+            }
+            return scope_stats.max_ns;
+        };
+        scope_stats.p50_ns  = percentile(0.5);
+        scope_stats.p90_ns  = percentile(0.9);
+        scope_stats.p99_ns  = percentile(0.99);
+        scope_stats.p999_ns = percentile(0.999);
+    }
+    return stats;
+}
+
+void reset()
+{
+    const size_t scope_count = profiler_scope::get_count();
+    for (size_t shard = 0; shard < SHARD_COUNT; ++shard)
+    {
+        for (size_t scope = 0; scope < scope_count; ++scope)
+        {
+            ScopeHistogram* histogram = find_histogram(shard, scope);
+            if (!histogram)
+                continue;
+            histogram->calls.store(0, std::memory_order_relaxed);
+            histogram->total_ns.store(0, std::memory_order_relaxed);
+            histogram->max_ns.store(0, std::memory_order_relaxed);
+            for (std::atomic_uint32_t& bucket : histogram->buckets)
+                bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void dump(std::ostream& output)
+{
+    const auto to_us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    output << "scope, function, file, calls, mean (us), p50 (us), p90 (us), p99 (us), p99.9 (us), max (us)\n";
+    for (const ScopeStats& stats : get_stats())
+    {
+        const ProfilerScope& scope = profiler_scope::get(stats.scope);
+        output << profiler_scope::get_display_name(scope) << ", " << scope.function_name << ", " << scope.file << ":" << scope.line << ", " << stats.calls << ", "
+               << to_us(stats.calls ? stats.total_ns / stats.calls : 0) << ", " << to_us(stats.p50_ns) << ", " << to_us(stats.p90_ns) << ", " << to_us(stats.p99_ns) << ", "
+               << to_us(stats.p999_ns) << ", " << to_us(stats.max_ns) << "\n";
+    }
+}
+
+bool dump(const std::filesystem::path& path)
+{
+    std::ofstream output(path);
+    if (!output)
+    {
+        LOG_ERROR("cannot write telemetry to %s", path.string().c_str());
+        return false;
+    }
+    dump(output);
+    return true;
+}
+
+void install_dump_signal()
+{
+#if !_WIN32
+    std::signal(SIGUSR1, [](int) { dump_requested = 1; });
+#endif
+}
+
+void request_dump()
+{
+    dump_requested = 1;
+}
+
+std::filesystem::path poll_dump_request(const std::filesystem::path& directory)
+{
+    if (!dump_requested)
+        return {};
+    dump_requested = 0;
+
+    const time_t now = time(nullptr);
+    struct tm    tstruct;
+    char         buf[80];
+#if _WIN32
+    localtime_s(&tstruct, &now);
+#else
+    localtime_r(&now, &tstruct);
+#endif
+    strftime(buf, sizeof(buf), "%Y-%m-%d_%H-%M-%S", &tstruct);
+
+    std::filesystem::create_directories(directory);
+    const std::filesystem::path path = directory / (std::string("Telemetry-") + buf + ".txt");
+    if (!dump(path))
+        return {};
+    LOG_INFO("telemetry dumped to %s", path.string().c_str());
+    return path;
+}
+} // namespace telemetry
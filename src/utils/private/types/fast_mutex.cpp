@@ -0,0 +1,90 @@
+#include "types/fast_mutex.h"
+
+#include "types/cpu_relax.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Pauses of the last backoff step, before parking
+static constexpr uint32_t MAX_SPIN = 64;
+
+// Spinning can't help when the lock owner is waiting for our core
+static const bool spin_enabled = std::thread::hardware_concurrency() > 1;
+
+static std::mutex& get_registry_lock()
+{
+    static std::mutex registry_lock;
+    return registry_lock;
+}
+static std::vector<FastMutex*>& get_named_locks()
+{
+    static std::vector<FastMutex*> named_locks;
+    return named_locks;
+}
+
+FastMutex::FastMutex(const char* in_name) : name(in_name)
+{
+    std::lock_guard lock(get_registry_lock());
+    get_named_locks().emplace_back(this);
+}
+
+FastMutex::~FastMutex()
+{
+    if (!name)
+        return;
+    std::lock_guard          lock(get_registry_lock());
+    std::vector<FastMutex*>& named_locks = get_named_locks();
+    named_locks.erase(std::remove(named_locks.begin(), named_locks.end(), this), named_locks.end());
+}
+
+void FastMutex::lock_contended()
+{
+    const auto start = std::chrono::steady_clock::now();
+    contentions.fetch_add(1, std::memory_order_relaxed);
+
+    bool acquired = false;
+    if (spin_enabled)
+        for (uint32_t spin = 1; spin <= MAX_SPIN && !acquired; spin *= 2)
+        {
+            for (uint32_t i = 0; i < spin; ++i)
+                CPU_RELAX();
+            // Only try when the lock looks free : failed exchanges steal the cache line from the owner
+            acquired = state.load(std::memory_order_relaxed) == UNLOCKED && try_lock();
+        }
+
+    if (!acquired)
+    {
+        // Mark the lock as contended so the owner wakes us up. We then own it in the contended state, which may cause a spurious notify at unlock
+        while (state.exchange(CONTENDED, std::memory_order_acquire) != UNLOCKED)
+        {
+            parks.fetch_add(1, std::memory_order_relaxed);
+            state.wait(CONTENDED, std::memory_order_relaxed);
+        }
+    }
+
+    wait_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+}
+
+FastMutex::Stats FastMutex::get_stats() const
+{
+    return Stats{
+        .contentions = contentions.load(std::memory_order_relaxed),
+        .parks       = parks.load(std::memory_order_relaxed),
+        .wait_time   = std::chrono::nanoseconds(wait_ns.load(std::memory_order_relaxed)),
+    };
+}
+
+void FastMutex::reset_stats()
+{
+    contentions.store(0, std::memory_order_relaxed);
+    parks.store(0, std::memory_order_relaxed);
+    wait_ns.store(0, std::memory_order_relaxed);
+}
+
+void FastMutex::for_each_named_lock(const std::function<void(const FastMutex&)>& function)
+{
+    std::lock_guard lock(get_registry_lock());
+    for (const FastMutex* mutex : get_named_locks())
+        function(*mutex);
+}
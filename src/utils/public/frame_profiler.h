@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "profiler_scope.h"
+#include "types/fast_mutex.h"
+
+/**
+ * Per-frame aggregation of the recorded scopes (BEGIN_RECORD / BEGIN_NAMED_RECORD).
+ * Scopes are organized as a tree per nesting path : the same scope opened from two different parents gives two nodes.
+ * For each node, the inclusive and exclusive (minus children) time of every frame is kept over the last frames, so budgets can be checked
+ * on percentiles from code (headless tests) as well as from the profiler window.
+ */
+class FrameProfiler final
+{
+  public:
+    using Duration = std::chrono::steady_clock::duration;
+
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+    static constexpr uint32_t NO_SCOPE  = UINT32_MAX;
+    static constexpr size_t   MAX_DEPTH = 64;
+
+    /** Scopes currently opened by an execution context (thread or fiber) */
+    struct ScopeStack
+    {
+        uint32_t nodes[MAX_DEPTH];
+        Duration children_time[MAX_DEPTH];
+        uint32_t depth = 0;
+    };
+
+    struct Percentiles
+    {
+        Duration p50 = Duration::zero();
+        Duration p95 = Duration::zero();
+        Duration p99 = Duration::zero();
+        Duration max = Duration::zero();
+    };
+
+    struct ScopeReport
+    {
+        uint32_t        id;
+        uint32_t        parent; // NO_PARENT for root scopes
+        uint32_t        depth;
+        ProfilerScopeId scope;
+        const char*     name;
+        const char*     function_name;
+        size_t          frame_count; // Frames this scope ran in, among the kept ones
+        Duration        last_inclusive;
+        Duration        last_exclusive;
+        uint32_t        last_calls;
+        Percentiles     inclusive;
+        Percentiles     exclusive;
+    };
+
+    static FrameProfiler& get();
+
+    void                      set_enabled(bool enabled);
+    [[nodiscard]] bool        is_enabled() const
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /** Number of frames percentiles are computed over. Clears the history */
+    void set_history_size(size_t frame_count);
+
+    /** Close the current frame : aggregate the scopes completed since the last call. Call once per frame from the main loop */
+    void end_frame();
+
+    /** Forget every kept frame */
+    void reset();
+
+    /** Report of every scope node, parents before their children */
+    [[nodiscard]] std::vector<ScopeReport> get_report() const;
+
+    /** Report of the first node named name (the record name, or the function name for unnamed records) */
+    [[nodiscard]] std::optional<ScopeReport> find_scope(std::string_view name) const;
+
+    [[nodiscard]] Percentiles get_frame_time() const;
+    [[nodiscard]] size_t      get_frame_count() const;
+
+    /** Used by StatRecorder. begin_scope returns the depth of the new scope, or NO_SCOPE */
+    uint32_t begin_scope(ProfilerScopeId scope);
+    void     end_scope(uint32_t depth, Duration duration);
+
+    /** Install the scope stack of the execution context running on the calling thread (fibers). Returns the previous one. nullptr restores the thread stack */
+    static ScopeStack* swap_scope_stack(ScopeStack* stack);
+
+  private:
+    struct FrameSample
+    {
+        Duration inclusive;
+        Duration exclusive;
+        uint32_t calls;
+    };
+
+    struct Node
+    {
+        ProfilerScopeId          scope;
+        uint32_t                 parent;
+        uint32_t                 depth;
+        std::vector<FrameSample> history; // Ring buffer of history_size samples
+        size_t                   history_head  = 0;
+        size_t                   history_count = 0;
+        FrameSample              frame         = {};
+    };
+
+    struct ThreadData;
+
+    ThreadData& get_thread_data();
+    uint32_t    register_node(uint32_t parent, ProfilerScopeId scope, uint32_t depth);
+    ScopeReport make_report(uint32_t id) const;
+    void        clear_history();
+
+    static Percentiles compute_percentiles(std::vector<Duration>& samples);
+
+    std::atomic_bool enabled = false;
+
+    // Guards nodes, thread_data and frame history. Scopes only take it the first time a thread meets a node.
+    mutable std::mutex                       lock;
+    std::vector<Node>                        nodes;
+    std::vector<std::unique_ptr<ThreadData>> thread_data;
+    size_t                                   history_size = 240;
+    std::vector<Duration>                    frame_times;
+    size_t                                   frame_time_head  = 0;
+    size_t                                   frame_time_count = 0;
+    std::chrono::steady_clock::time_point    last_frame_end;
+};
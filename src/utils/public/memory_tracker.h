@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/**
+ * Subsystems memory is attributed to
+ */
+enum class MemoryTag : uint8_t
+{
+    Untagged,
+    SceneProxy,
+    Assets,
+    ShaderBuffer,
+    ShaderModule,
+    JobSystem,
+    Count
+};
+
+/**
+ * Allocation tracking : live and peak bytes and allocation counts per tag.
+ * Memory allocated with memory::malloc / memory::realloc must be released with memory::free. Memory owned by other allocators (std containers,
+ * aligned pages, mapped stacks...) can be accounted with track_allocation / track_free.
+ * With the HE_TRACK_GLOBAL_ALLOCATIONS CMake option, the global operator new is also tracked, with the tag of the calling thread's TagScope.
+ */
+namespace memory
+{
+struct TagStats
+{
+    int64_t live_bytes        = 0;
+    int64_t peak_bytes        = 0;
+    int64_t live_allocations  = 0;
+    int64_t total_allocations = 0;
+};
+
+void* malloc(size_t size, MemoryTag tag);
+void* realloc(void* ptr, size_t size, MemoryTag tag);
+void  free(void* ptr);
+
+void track_allocation(MemoryTag tag, size_t size);
+void track_free(MemoryTag tag, size_t size);
+
+[[nodiscard]] TagStats    get_stats(MemoryTag tag);
+[[nodiscard]] const char* get_tag_name(MemoryTag tag);
+
+/** Is the global operator new tracked */
+[[nodiscard]] bool is_global_hook_enabled();
+
+/** Tag given to global operator new allocations of the calling thread */
+[[nodiscard]] MemoryTag get_current_tag();
+
+/** Attribute the global allocations of the calling thread to a tag until the end of the scope */
+class TagScope final
+{
+  public:
+    explicit TagScope(MemoryTag tag);
+    ~TagScope();
+
+    TagScope(const TagScope&)            = delete;
+    TagScope& operator=(const TagScope&) = delete;
+
+  private:
+    MemoryTag previous_tag;
+};
+
+/** Standard allocator attributing container storage to a tag */
+template <typename ObjectType, MemoryTag Tag> struct TTaggedAllocator
+{
+    static_assert(alignof(ObjectType) <= alignof(std::max_align_t), "over-aligned types are not supported by memory::malloc");
+
+    using value_type = ObjectType;
+
+    template <typename OtherType> struct rebind
+    {
+        using other = TTaggedAllocator<OtherType, Tag>;
+    };
+
+    TTaggedAllocator() = default;
+    template <typename OtherType> TTaggedAllocator(const TTaggedAllocator<OtherType, Tag>&)
+    {
+    }
+
+    ObjectType* allocate(size_t count)
+    {
+        if (void* ptr = memory::malloc(count * sizeof(ObjectType), Tag))
+            return static_cast<ObjectType*>(ptr);
+        throw std::bad_alloc();
+    }
+
+    void deallocate(ObjectType* ptr, size_t)
+    {
+        memory::free(ptr);
+    }
+
+    template <typename OtherType> bool operator==(const TTaggedAllocator<OtherType, Tag>&) const
+    {
+        return true;
+    }
+};
+} // namespace memory
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Hardware performance counters of the calling thread, read through Linux perf_event.
+ * Only compiled in with the HE_PROFILER_HARDWARE_COUNTERS CMake option (defines PROFILER_HARDWARE_COUNTERS). Elsewhere, or when the kernel
+ * denies access (see /proc/sys/kernel/perf_event_paranoid), reads fail and the profiler records plain stats.
+ */
+namespace perf_counters
+{
+	enum class Counter : uint8_t
+	{
+		Cycles,
+		Instructions,
+		CacheMisses,
+		BranchMisses,
+		Count
+	};
+
+	inline constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::Count);
+
+	struct Sample
+	{
+		uint64_t values[COUNTER_COUNT] = {};
+		// Identifies the thread whose counters were read : samples of different threads can't be compared. 0 if nothing was read
+		uint32_t group = 0;
+
+		[[nodiscard]] uint64_t operator[](Counter counter) const { return values[static_cast<size_t>(counter)]; }
+	};
+
+	/** Read the counters of the calling thread. They are opened on the first read of each thread */
+	bool read(Sample& sample);
+
+	/** Can the calling thread read its counters */
+	[[nodiscard]] bool is_available();
+
+	[[nodiscard]] const char* get_counter_name(Counter counter);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "perf_counters.h"
+#include "profiler_scope.h"
+
+/**
+ * Binary profiler capture, streamed to disk while recording.
+ *
+ * File layout : header (magic, version) followed by records, each starting with a RecordType byte :
+ * - Scope  : varint scope id, name, function name, file (varint length + characters each), varint line, uint32 color. Emitted the first time a scope is used.
+ * - Thread : varint id, uint64 hash of the thread id. Emitted the first time a thread records a stat.
+ * - Stat   : varint thread, varint scope id, zigzag varint start delta (ns, relative to the previous stat), varint duration (ns).
+ * - CountedStat : a Stat followed by a varint per hardware counter (perf_counters::Counter order), counted over the scope.
+ * Integers are little endian.
+ */
+namespace profiler_capture
+{
+inline constexpr char     MAGIC[4] = {'H', 'E', 'P', 'C'};
+inline constexpr uint32_t VERSION  = 3;
+
+enum class RecordType : uint8_t
+{
+	Scope  = 1,
+	Thread = 2,
+	Stat   = 3,
+	CountedStat = 4,
+};
+
+struct Sample
+{
+	uint32_t thread;
+	ProfilerScopeId scope;
+	int64_t  start; // ns since the profiler creation
+	uint64_t duration; // ns
+	bool has_counters = false;
+	uint64_t counters[perf_counters::COUNTER_COUNT] = {};
+
+	[[nodiscard]] uint64_t get_counter(perf_counters::Counter counter) const { return counters[static_cast<size_t>(counter)]; }
+};
+
+struct ScopeInfo
+{
+	std::string name;
+	std::string function_name;
+	std::string file;
+	uint32_t line = 0;
+	uint32_t color = 0;
+};
+
+class Writer final
+{
+public:
+	~Writer();
+
+	bool open(const std::filesystem::path& path);
+	void close();
+
+	[[nodiscard]] bool is_open() const { return output.is_open(); }
+
+	/** Counters is null or holds perf_counters::COUNTER_COUNT values */
+	void write(const ProfilerScope& scope, std::thread::id thread, int64_t start, uint64_t duration, const uint64_t* counters = nullptr);
+
+private:
+	void     write_scope(const ProfilerScope& scope);
+	void     write_string(const char* string);
+	uint32_t get_thread_id(std::thread::id thread);
+	void     flush();
+
+	std::ofstream output;
+	std::vector<uint8_t> buffer;
+	std::vector<bool> written_scopes;
+	std::unordered_map<std::thread::id, uint32_t> thread_ids;
+	int64_t last_start = 0;
+};
+
+class Reader final
+{
+public:
+	bool open(const std::filesystem::path& path);
+
+	/** Read the next sample. Returns false at the end of the capture or if it is corrupted */
+	bool next(Sample& sample);
+
+	/** Description of a scope. Only valid for scopes of the samples returned so far */
+	[[nodiscard]] const ScopeInfo& get_scope(ProfilerScopeId id) const;
+	[[nodiscard]] uint64_t get_thread_hash(uint32_t id) const;
+	[[nodiscard]] bool is_corrupted() const { return corrupted; }
+
+private:
+	bool read_varint(uint64_t& value);
+	bool read_string(std::string& string);
+
+	std::ifstream input;
+	std::vector<ScopeInfo> scopes;
+	std::vector<uint64_t> threads;
+	int64_t last_start = 0;
+	bool corrupted = false;
+};
+
+} // namespace profiler_capture
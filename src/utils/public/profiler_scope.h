@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+using ProfilerScopeId = uint16_t;
+
+/**
+ * Static description of a profiled scope, registered once per call site (see the BEGIN_RECORD macros).
+ * Samples only reference their scope by id.
+ */
+struct ProfilerScope
+{
+	const char* name;
+	const char* function_name;
+	const char* file;
+	uint32_t line;
+	uint32_t color; // ImGui packed color (IM_COL32)
+	ProfilerScopeId id;
+	bool read_counters; // Hardware counters are read at the scope begin and end (see perf_counters.h)
+};
+
+namespace profiler_scope
+{
+	// IM_COL32(255, 0, 0, 100)
+	inline constexpr uint32_t DEFAULT_COLOR = 0x640000FF;
+	inline constexpr size_t MAX_SCOPES = 65536;
+
+	/** Register a new scope. Strings must outlive the program (literals) */
+	const ProfilerScope& register_scope(const char* name, const char* function_name, const char* file, uint32_t line, uint32_t color = DEFAULT_COLOR, bool read_counters = false);
+
+	/** Scope from its id. Lock free */
+	const ProfilerScope& get(ProfilerScopeId id);
+
+	size_t get_count();
+
+	/** The record name, or the function name for unnamed records */
+	inline const char* get_display_name(const ProfilerScope& scope)
+	{
+		return scope.name && *scope.name ? scope.name : scope.function_name;
+	}
+}
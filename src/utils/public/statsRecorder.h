@@ -1,25 +1,44 @@
 #pragma once
 
-#if CXX_MSVC
-#define BEGIN_RECORD() StatRecorder __lambda_stat_recorder("", ##__FUNCTION__)
-#define END_RECORD() __lambda_stat_recorder.end()
-#define ADD_TIMEPOINT() { if (Profiler::get().is_profiler_recording()) StatRecorder __lambda_named_timepoint("", ##__FUNCTION__, true); }
-#define ADD_NAMED_TIMEPOINT(name)  { if (Profiler::get().is_profiler_recording()) StatRecorder name(#name, ##__FUNCTION__, true); }
-#define BEGIN_NAMED_RECORD(name) StatRecorder name(#name, ##__FUNCTION__)
-#define END_NAMED_RECORD(name) name.end()
+/**
+ * Profiler markers. Each call site registers its scope once, in a function static : samples only carry the scope id.
+ * Profiling can be compiled out with the HE_ENABLE_PROFILER CMake option (defines PROFILER_DISABLED).
+ */
+#if PROFILER_DISABLED
+#define BEGIN_RECORD() ((void)0)
+#define END_RECORD() ((void)0)
+#define ADD_TIMEPOINT() ((void)0)
+#define ADD_NAMED_TIMEPOINT(name) ((void)0)
+#define BEGIN_NAMED_RECORD(name) ((void)0)
+#define BEGIN_COLORED_RECORD(name, color) ((void)0)
+#define BEGIN_COUNTED_RECORD(name) ((void)0)
+#define END_NAMED_RECORD(name) ((void)0)
 #else
-#define BEGIN_RECORD() StatRecorder __lambda_stat_recorder("", __FUNCTION__)
+#define PROFILER_SCOPE(variable, name, color) static const ProfilerScope& variable = profiler_scope::register_scope(name, __FUNCTION__, __FILE__, __LINE__, color)
+#define PROFILER_COUNTED_SCOPE(variable, name) static const ProfilerScope& variable = profiler_scope::register_scope(name, __FUNCTION__, __FILE__, __LINE__, profiler_scope::DEFAULT_COLOR, true)
+#define BEGIN_RECORD() PROFILER_SCOPE(__lambda_stat_scope, "", profiler_scope::DEFAULT_COLOR); StatRecorder __lambda_stat_recorder(__lambda_stat_scope)
 #define END_RECORD() __lambda_stat_recorder.end()
-#define ADD_TIMEPOINT() { if (Profiler::get().is_profiler_recording()) StatRecorder __lambda_named_timepoint("", __FUNCTION__, true); }
-#define ADD_NAMED_TIMEPOINT(name)  { if (Profiler::get().is_profiler_recording()) StatRecorder name(#name, __FUNCTION__, true); }
-#define BEGIN_NAMED_RECORD(name) StatRecorder name(#name, __FUNCTION__)
+#define ADD_TIMEPOINT() { PROFILER_SCOPE(__lambda_timepoint_scope, "", profiler_scope::DEFAULT_COLOR); StatRecorder::add_timepoint(__lambda_timepoint_scope); }
+#define ADD_NAMED_TIMEPOINT(name) { PROFILER_SCOPE(name##_scope, #name, profiler_scope::DEFAULT_COLOR); StatRecorder::add_timepoint(name##_scope); }
+#define BEGIN_NAMED_RECORD(name) PROFILER_SCOPE(name##_scope, #name, profiler_scope::DEFAULT_COLOR); StatRecorder name(name##_scope)
+#define BEGIN_COLORED_RECORD(name, color) PROFILER_SCOPE(name##_scope, #name, color); StatRecorder name(name##_scope)
+// Also reads the hardware counters while recording (see perf_counters.h). A read costs a syscall at each end : keep it for coarse scopes
+#define BEGIN_COUNTED_RECORD(name) PROFILER_COUNTED_SCOPE(name##_scope, #name); StatRecorder name(name##_scope)
 #define END_NAMED_RECORD(name) name.end()
 #endif
 
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <thread>
-#include <forward_list>
+#include <vector>
+
+#include "frame_profiler.h"
+#include "perf_counters.h"
+#include "profiler_capture.h"
+#include "profiler_scope.h"
+#include "types/spsc_ring.h"
 
 typedef std::chrono::steady_clock record_clock;
 
@@ -27,19 +46,27 @@ class StatRecorder final
 {
 public:
 
-	StatRecorder(const char* name, const char* function_name, bool auto_close = false);
+	explicit StatRecorder(const ProfilerScope& scope);
 	~StatRecorder();
 	
 	void end();
 
+	/** Record a zero length stat, only while the profiler is recording */
+	static void add_timepoint(const ProfilerScope& scope);
+
 private:
 	record_clock::time_point start_time;
-	const char* recorder_name;
-	const char* recorder_function_name;
+	perf_counters::Sample start_counters;
+	uint32_t frame_scope;
+	ProfilerScopeId scope_id;
+	bool has_counters;
 	bool has_ended;
-	std::thread::id thread_id;
 };
 
+/**
+ * Each thread pushes its stats into its own preallocated ring : recording a scope never locks nor allocates.
+ * While recording, a collector thread drains the rings into the history and streams them to a binary capture (see profiler_capture.h).
+ */
 class Profiler final
 {
 	friend StatRecorder;
@@ -47,12 +74,24 @@ public:
 
 	struct Stat
 	{
-		const char* name;
-		const char* function_name;
 		record_clock::time_point date;
 		record_clock::duration duration;
-		std::thread::id thread;
+		ProfilerScopeId scope;
+		uint32_t thread; // Index of the thread buffer in the profiler, filled by the collector. Buffers of exited threads are reused
+	};
+
+	/** Stat of a scope reading the hardware counters, with the counter deltas over the scope */
+	struct CountedStat
+	{
+		Stat stat;
+		uint64_t counters[perf_counters::COUNTER_COUNT];
 	};
+
+	// Stats a thread can record between two collections. Further stats are dropped and counted.
+	static constexpr size_t STATS_PER_THREAD = 1 << 14;
+	static constexpr size_t COUNTED_STATS_PER_THREAD = 1 << 10;
+	// Most recent stats kept for the profiler window. The capture holds the whole record.
+	static constexpr size_t HISTORY_SIZE = 1 << 18;
 	
 	explicit Profiler(bool auto_record);
 	~Profiler();
@@ -62,18 +101,48 @@ public:
 	void begin_record(bool silent = false);
 	void end_record();
 
-	[[nodiscard]] bool is_profiler_recording() const { return is_recording; }
+	[[nodiscard]] bool is_profiler_recording() const { return is_recording.load(std::memory_order_relaxed); }
 
 	[[nodiscard]] record_clock::duration get_elapsed_time() const { return record_clock::now() - record_start; }
-	[[nodiscard]] std::forward_list<Stat> get_last_result() const { return last_result; }
+	/** The last HISTORY_SIZE stats of the last record, oldest first */
+	[[nodiscard]] std::vector<Stat> get_last_result() const { return last_result; }
+	[[nodiscard]] size_t get_dropped_stat_count() const { return last_dropped_stats; }
+	[[nodiscard]] const std::filesystem::path& get_last_capture_path() const { return last_capture_path; }
+
+	/** Thread of the Stat::thread index */
+	[[nodiscard]] std::thread::id get_thread_id(uint32_t thread) const;
 
 private:
-	std::mutex access_lock;
-	bool is_recording;
-	void push_stat(Stat stat);
-	void store_stats();
+	struct ThreadBuffer
+	{
+		TSpscRing<Stat, STATS_PER_THREAD> stats;
+		TSpscRing<CountedStat, COUNTED_STATS_PER_THREAD> counted_stats;
+		std::atomic_size_t dropped = 0;
+		std::thread::id thread;
+		uint32_t index;
+	};
+
+	void push_stat(const Stat& stat);
+	void push_counted_stat(const CountedStat& stat);
+	ThreadBuffer& get_thread_buffer();
+	void release_thread_buffer(ThreadBuffer& buffer);
+	void collect_stats();
+	void collect_buffer(ThreadBuffer& buffer);
+	void collector_main();
+	void open_capture();
+
+	// Guards thread_buffers registration, free_thread_buffers and history
+	mutable std::mutex access_lock;
+	std::atomic_bool is_recording = false;
 	record_clock::time_point profiler_creation_time;
 	record_clock::time_point record_start;
-	std::forward_list<Stat> history;
-	std::forward_list<Stat> last_result;
-};
\ No newline at end of file
+	std::vector<std::unique_ptr<ThreadBuffer>> thread_buffers;
+	std::vector<ThreadBuffer*> free_thread_buffers; // Buffers of exited threads, drained
+	std::thread collector_thread;
+	std::vector<Stat> history; // Ring of the most recent stats
+	size_t history_next = 0;
+	std::vector<Stat> last_result;
+	profiler_capture::Writer capture;
+	std::filesystem::path last_capture_path;
+	size_t last_dropped_stats = 0;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <vector>
+
+#include "profiler_scope.h"
+
+/**
+ * Always-on telemetry : every completed scope (BEGIN_RECORD...) adds its duration to a fixed size histogram of its scope.
+ * Each thread records into one of a fixed number of shards, merged when reading. Memory only grows with the number of scopes (times the shards
+ * recording them), never with time, so it can stay enabled in production and be dumped on demand
+ * (dump, or the dump signal polled by the main loop) after an intermittent hitch.
+ *
+ * Histograms are log-linear (HDR style) : durations are exact below SUB_BUCKET_COUNT ns, and within 1 / SUB_BUCKET_COUNT relative precision above.
+ */
+namespace telemetry
+{
+inline constexpr uint32_t SUB_BUCKET_BITS  = 5;
+inline constexpr uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+// Longer durations are counted in the last bucket (~18 minutes)
+inline constexpr uint32_t MAX_DURATION_BITS = 40;
+inline constexpr size_t   BUCKET_COUNT      = SUB_BUCKET_COUNT * (MAX_DURATION_BITS - SUB_BUCKET_BITS + 1);
+
+struct ScopeStats
+{
+    ProfilerScopeId scope;
+    uint64_t        calls    = 0;
+    uint64_t        total_ns = 0;
+    uint64_t        max_ns   = 0;
+    uint64_t        p50_ns   = 0;
+    uint64_t        p90_ns   = 0;
+    uint64_t        p99_ns   = 0;
+    uint64_t        p999_ns  = 0;
+};
+
+void               set_enabled(bool enabled);
+[[nodiscard]] bool is_enabled();
+
+/** Add a duration to the histogram of a scope in the shard of the calling thread. Used by StatRecorder, lock free */
+void record(ProfilerScopeId scope, uint64_t duration_ns);
+
+/** Stats of every scope recorded since the last reset, by scope id, merged over the shards */
+[[nodiscard]] std::vector<ScopeStats> get_stats();
+
+/** Clear every histogram. Concurrent records may be lost */
+void reset();
+
+/** Write a text report of get_stats() */
+void dump(std::ostream& output);
+bool dump(const std::filesystem::path& path);
+
+/** Histogram bucket of a duration, and the highest duration of a bucket */
+[[nodiscard]] size_t   get_bucket(uint64_t duration_ns);
+[[nodiscard]] uint64_t get_bucket_max(size_t bucket);
+
+/**
+ * Request a dump from outside the process : SIGUSR1 on POSIX systems (no-op elsewhere).
+ * The handler only flags the request, poll_dump_request performs it.
+ */
+void install_dump_signal();
+
+/** Dump to <directory>/Telemetry-<date>.txt if a dump was requested. Returns the dump path, or an empty path */
+std::filesystem::path poll_dump_request(const std::filesystem::path& directory);
+void                  request_dump();
+} // namespace telemetry
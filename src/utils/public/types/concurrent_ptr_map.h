@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "fast_mutex.h"
+
+/**
+ * Concurrent map from 64 bit keys to pointers, for read-mostly registries.
+ * Reads never lock nor write shared memory : each shard is an open addressing table whose slots are atomics. Writers lock their shard.
+ * A key can be reserved before its value exists : it is then reported by contains (so a concurrent insert of the same key fails) but not by find.
+ *
+ * Tables replaced when a shard grows are kept until the map is destroyed, as readers may still be probing them. Erased slots are reused by
+ * later inserts, which keeps rebuilds (and retired tables) rare for registries of a stable size : readers check that the value they read is
+ * still in the slot after reading its key, so they never pair a value with the key of a later insert.
+ */
+template<typename ValueType, size_t ShardCount = 16>
+class TConcurrentPtrMap final
+{
+	static_assert(ShardCount > 0 && (ShardCount & (ShardCount - 1)) == 0, "shard count must be a power of two");
+	static_assert(ShardCount <= 64, "shards are selected with the 6 high bits of the key hash");
+
+public:
+	TConcurrentPtrMap()
+	{
+		for (Shard& shard : shards)
+			shard.table.store(shard.allocate_table(MIN_CAPACITY), std::memory_order_relaxed);
+	}
+
+	TConcurrentPtrMap(const TConcurrentPtrMap&) = delete;
+	TConcurrentPtrMap& operator=(const TConcurrentPtrMap&) = delete;
+
+	/** nullptr if the key is missing or only reserved. Lock free */
+	[[nodiscard]] ValueType* find(uint64_t key) const
+	{
+		ValueType* value = find_slot_value(key);
+		return value == reserved_value() ? nullptr : value;
+	}
+
+	/** Is the key inserted or reserved. Lock free */
+	[[nodiscard]] bool contains(uint64_t key) const
+	{
+		return find_slot_value(key) != nullptr;
+	}
+
+	/** Insert a value, or only reserve the key if value is nullptr. Returns false if the key is already inserted or reserved */
+	bool try_insert(uint64_t key, ValueType* value)
+	{
+		Shard& shard = get_shard(key);
+		std::lock_guard lock(shard.write_lock);
+		if (shard.used_slots + 1 > shard.table.load(std::memory_order_relaxed)->capacity * 3 / 4)
+			shard.grow();
+
+		const Table* table = shard.table.load(std::memory_order_relaxed);
+		Slot* target = nullptr;
+		for (size_t i = get_slot_index(key);; ++i)
+		{
+			Slot& slot = table->slots[i & (table->capacity - 1)];
+			ValueType* slot_value = slot.value.load(std::memory_order_relaxed);
+			if (!slot_value)
+			{
+				if (!target)
+				{
+					target = &slot;
+					++shard.used_slots;
+				}
+				break;
+			}
+			if (slot_value == erased_value())
+			{
+				if (!target)
+					target = &slot;
+			}
+			else if (slot.key.load(std::memory_order_relaxed) == key)
+				return false;
+		}
+
+		// Readers check the key after the value : the key must be visible first, and the erased value before the key
+		target->key.store(key, std::memory_order_release);
+		target->value.store(value ? value : reserved_value(), std::memory_order_release);
+		total_size.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	/** Give its value to a reserved key. Returns false if the key is not reserved */
+	bool publish(uint64_t key, ValueType* value)
+	{
+		Shard& shard = get_shard(key);
+		std::lock_guard lock(shard.write_lock);
+		Slot* slot = shard.find_live_slot(key);
+		if (!slot || slot->value.load(std::memory_order_relaxed) != reserved_value())
+			return false;
+		slot->value.store(value, std::memory_order_release);
+		return true;
+	}
+
+	/** Returns the erased value (nullptr for missing or reserved keys) */
+	ValueType* erase(uint64_t key)
+	{
+		Shard& shard = get_shard(key);
+		std::lock_guard lock(shard.write_lock);
+		Slot* slot = shard.find_live_slot(key);
+		if (!slot)
+			return nullptr;
+		ValueType* value = slot->value.exchange(erased_value(), std::memory_order_release);
+		total_size.fetch_sub(1, std::memory_order_relaxed);
+		return value == reserved_value() ? nullptr : value;
+	}
+
+	/** Call function(key, value) on every inserted value. Concurrent writes may or may not be seen */
+	template<typename Function>
+	void for_each(Function&& function) const
+	{
+		for (const Shard& shard : shards)
+		{
+			const Table* table = shard.table.load(std::memory_order_acquire);
+			for (size_t i = 0; i < table->capacity; ++i)
+			{
+				const Slot& slot = table->slots[i];
+				ValueType* value = slot.value.load(std::memory_order_acquire);
+				if (!value || value == erased_value() || value == reserved_value())
+					continue;
+				const uint64_t key = slot.key.load(std::memory_order_acquire);
+				// Skip slots erased and reused meanwhile : the key may not be the one of the value
+				if (slot.value.load(std::memory_order_relaxed) == value)
+					function(key, value);
+			}
+		}
+	}
+
+	/** Inserted and reserved keys. Approximate when used concurrently */
+	[[nodiscard]] size_t size() const { return total_size.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr size_t MIN_CAPACITY = 64;
+
+	static ValueType* reserved_value() { return reinterpret_cast<ValueType*>(uintptr_t(1)); }
+	static ValueType* erased_value() { return reinterpret_cast<ValueType*>(uintptr_t(2)); }
+
+	struct Slot
+	{
+		std::atomic_uint64_t key = 0;
+		std::atomic<ValueType*> value = nullptr; // nullptr for never used slots
+	};
+
+	struct Table
+	{
+		size_t capacity;
+		std::unique_ptr<Slot[]> slots;
+	};
+
+	struct alignas(64) Shard
+	{
+		Table* allocate_table(size_t capacity)
+		{
+			return tables.emplace_back(std::make_unique<Table>(Table{.capacity = capacity, .slots = std::make_unique<Slot[]>(capacity)})).get();
+		}
+
+		// Writers only
+		Slot* find_live_slot(uint64_t key) const
+		{
+			const Table* table = this->table.load(std::memory_order_relaxed);
+			for (size_t i = get_slot_index(key);; ++i)
+			{
+				Slot& slot = table->slots[i & (table->capacity - 1)];
+				ValueType* value = slot.value.load(std::memory_order_relaxed);
+				if (!value)
+					return nullptr;
+				if (value != erased_value() && slot.key.load(std::memory_order_relaxed) == key)
+					return &slot;
+			}
+		}
+
+		// Move live slots to a new table sized for twice as many, then publish it
+		void grow()
+		{
+			const Table* old_table = table.load(std::memory_order_relaxed);
+			size_t live_slots = 0;
+			for (size_t i = 0; i < old_table->capacity; ++i)
+			{
+				ValueType* value = old_table->slots[i].value.load(std::memory_order_relaxed);
+				live_slots += value && value != erased_value();
+			}
+
+			Table* new_table = allocate_table(std::bit_ceil(std::max(MIN_CAPACITY, (live_slots + 1) * 2)));
+			for (size_t i = 0; i < old_table->capacity; ++i)
+			{
+				const Slot& old_slot = old_table->slots[i];
+				ValueType* value = old_slot.value.load(std::memory_order_relaxed);
+				if (!value || value == erased_value())
+					continue;
+				const uint64_t key = old_slot.key.load(std::memory_order_relaxed);
+				size_t index = get_slot_index(key);
+				while (new_table->slots[index & (new_table->capacity - 1)].value.load(std::memory_order_relaxed))
+					++index;
+				Slot& new_slot = new_table->slots[index & (new_table->capacity - 1)];
+				new_slot.key.store(key, std::memory_order_relaxed);
+				new_slot.value.store(value, std::memory_order_relaxed);
+			}
+			used_slots = live_slots;
+			table.store(new_table, std::memory_order_release);
+		}
+
+		FastMutex write_lock;
+		std::atomic<Table*> table = nullptr;
+		std::vector<std::unique_ptr<Table>> tables; // Current and retired tables
+		size_t used_slots = 0; // Live, reserved and erased slots of the current table
+	};
+
+	// Keys are often hashes already, but not always well distributed : mix them before splitting their bits between shard and slot
+	static uint64_t mix(uint64_t key)
+	{
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdull;
+		key ^= key >> 33;
+		return key;
+	}
+
+	static size_t get_slot_index(uint64_t key) { return static_cast<size_t>(mix(key)); }
+
+	Shard& get_shard(uint64_t key) { return shards[(mix(key) >> 58) & (ShardCount - 1)]; }
+	const Shard& get_shard(uint64_t key) const { return shards[(mix(key) >> 58) & (ShardCount - 1)]; }
+
+	ValueType* find_slot_value(uint64_t key) const
+	{
+		const Table* table = get_shard(key).table.load(std::memory_order_acquire);
+		for (size_t i = get_slot_index(key);;)
+		{
+			const Slot& slot = table->slots[i & (table->capacity - 1)];
+			ValueType* value = slot.value.load(std::memory_order_acquire);
+			if (!value)
+				return nullptr;
+			if (value == erased_value())
+			{
+				++i;
+				continue;
+			}
+			// An erased slot can be reused for another key while we read it : the key belongs to the value only if the value is still there.
+			// Else read the slot again
+			const uint64_t slot_key = slot.key.load(std::memory_order_acquire);
+			if (slot.value.load(std::memory_order_relaxed) != value)
+				continue;
+			if (slot_key == key)
+				return value;
+			++i;
+		}
+	}
+
+	Shard shards[ShardCount];
+	std::atomic_size_t total_size = 0;
+};
@@ -1,35 +1,69 @@
 #pragma once
-#include <mutex>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
 
-#include "cpputils/logger.hpp"
-
+/**
+ * Adaptive lock for short critical sections : an uncontended lock / unlock is a single atomic operation.
+ * A contended lock spins with exponential backoff (no spinning on single core machines), then parks the thread with atomic wait (futex on Linux).
+ * Contention (slow path only) is counted per instance. Named locks are also listed for the profiler window (see for_each_named_lock).
+ */
 class FastMutex final
 {
   public:
-    FastMutex()                 = default;
-    FastMutex(const FastMutex&) = delete;
+    struct Stats
+    {
+        uint64_t                 contentions = 0; // lock() calls that did not get the lock at once
+        uint64_t                 parks       = 0; // times a thread went to sleep
+        std::chrono::nanoseconds wait_time   = std::chrono::nanoseconds::zero();
+    };
+
+    FastMutex() = default;
+    explicit FastMutex(const char* in_name);
+    ~FastMutex();
+    FastMutex(const FastMutex&)            = delete;
     FastMutex& operator=(const FastMutex&) = delete;
 
     void lock()
     {
-        for (;;)
-        {
-            if (!b_lock.exchange(true, std::memory_order_acquire))
-            {
-                break;
-            }
-            while (b_lock.load(std::memory_order_relaxed))
-            {
-            }
-        }
+        if (!try_lock())
+            lock_contended();
+    }
+
+    [[nodiscard]] bool try_lock()
+    {
+        uint32_t expected = UNLOCKED;
+        return state.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
     }
 
     void unlock()
     {
-        b_lock.store(false, std::memory_order_release);
+        if (state.exchange(UNLOCKED, std::memory_order_release) == CONTENDED)
+            state.notify_one();
+    }
+
+    [[nodiscard]] Stats       get_stats() const;
+    void                      reset_stats();
+    [[nodiscard]] const char* get_name() const
+    {
+        return name;
     }
 
+    /** Call function on every living named lock */
+    static void for_each_named_lock(const std::function<void(const FastMutex&)>& function);
+
   private:
-    std::atomic_bool b_lock = {false};
+    static constexpr uint32_t UNLOCKED  = 0;
+    static constexpr uint32_t LOCKED    = 1;
+    static constexpr uint32_t CONTENDED = 2; // Locked, and some threads may be parked
+
+    void lock_contended();
+
+    std::atomic_uint32_t state       = UNLOCKED;
+    const char*          name        = nullptr;
+    std::atomic_uint64_t contentions = 0;
+    std::atomic_uint64_t parks       = 0;
+    std::atomic_int64_t  wait_ns     = 0;
 };
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+/**
+ * Multi producer / multi consumer queue : a bounded lock free ring (Dmitry Vyukov's design, one sequence number per cell) backed by an
+ * unbounded mutex guarded overflow segment, so push never fails.
+ * While the overflow is in use, pushes go to it too and pops drain the ring first : objects are popped in push order as long as a
+ * single producer is involved, and never starve in the overflow.
+ * Capacity must be a power of two. ObjectType must be default constructible and movable.
+ */
+template<typename ObjectType, size_t Capacity>
+class TMpmcQueue final
+{
+	static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "queue capacity must be a power of two");
+
+public:
+	TMpmcQueue() : cells(std::make_unique<Cell[]>(Capacity))
+	{
+		for (size_t i = 0; i < Capacity; ++i)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	TMpmcQueue(const TMpmcQueue&) = delete;
+	TMpmcQueue& operator=(const TMpmcQueue&) = delete;
+
+	void push(ObjectType object)
+	{
+		if (overflow_size.load(std::memory_order_relaxed) == 0 && try_push(object))
+			return;
+		std::lock_guard lock(overflow_lock);
+		overflow.emplace_back(std::move(object));
+		overflow_size.fetch_add(1, std::memory_order_release);
+	}
+
+	/** Push to the ring only. Returns false, leaving object untouched, when it is full */
+	bool try_push(ObjectType& object)
+	{
+		size_t position = enqueue_position.load(std::memory_order_relaxed);
+		Cell* cell;
+		while (true)
+		{
+			cell = &cells[position & (Capacity - 1)];
+			const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+			if (difference == 0)
+			{
+				if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+				return false; // The cell still holds the object pushed one lap ago
+			else
+				position = enqueue_position.load(std::memory_order_relaxed);
+		}
+		cell->object = std::move(object);
+		cell->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Returns false when the queue is empty */
+	bool pop(ObjectType& object)
+	{
+		if (try_pop(object))
+			return true;
+		if (overflow_size.load(std::memory_order_acquire) == 0)
+			return false;
+		std::lock_guard lock(overflow_lock);
+		if (overflow.empty())
+			return false;
+		object = std::move(overflow.front());
+		overflow.pop_front();
+		overflow_size.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	/** Pop from the ring only */
+	bool try_pop(ObjectType& object)
+	{
+		size_t position = dequeue_position.load(std::memory_order_relaxed);
+		Cell* cell;
+		while (true)
+		{
+			cell = &cells[position & (Capacity - 1)];
+			const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+			if (difference == 0)
+			{
+				if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+				return false; // Not pushed yet
+			else
+				position = dequeue_position.load(std::memory_order_relaxed);
+		}
+		object = std::move(cell->object);
+		// Release what the object owns now, not when the cell is reused
+		cell->object = ObjectType();
+		cell->sequence.store(position + Capacity, std::memory_order_release);
+		return true;
+	}
+
+	/** Approximate when used concurrently */
+	[[nodiscard]] size_t size() const
+	{
+		const size_t enqueued = enqueue_position.load(std::memory_order_relaxed);
+		const size_t dequeued = dequeue_position.load(std::memory_order_relaxed);
+		return (enqueued > dequeued ? enqueued - dequeued : 0) + overflow_size.load(std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] bool is_empty() const { return size() == 0; }
+
+	[[nodiscard]] static constexpr size_t capacity() { return Capacity; }
+
+private:
+	struct Cell
+	{
+		std::atomic_size_t sequence;
+		ObjectType object;
+	};
+
+	std::unique_ptr<Cell[]> cells;
+	// Producers and consumers update different indices : keep them on separate cache lines
+	alignas(64) std::atomic_size_t enqueue_position = 0;
+	alignas(64) std::atomic_size_t dequeue_position = 0;
+	alignas(64) std::atomic_size_t overflow_size = 0;
+	std::mutex overflow_lock;
+	std::deque<ObjectType> overflow;
+};
@@ -1,8 +1,9 @@
 #pragma once
 
-#include <mutex>
-#include <vector>
-#include <cpputils/logger.hpp>
+#include <bit>
+#include <memory>
+
+#include "mpmc_queue.h"
 
 template<typename ObjectType>
 class IObjectPool
@@ -14,56 +15,31 @@ private:
 	virtual std::shared_ptr<ObjectType> pop() = 0;
 };
 
+/**
+ * Shared object queue, lock free up to PoolSize objects (see TMpmcQueue). Pushing more never fails : extra objects wait in an overflow segment.
+ */
 template<typename ObjectType, size_t PoolSize>
 class TObjectPool : public IObjectPool<ObjectType>
 {
 public:
 
-	TObjectPool() {
-		pool.resize(PoolSize);
-	}
-
 	virtual ~TObjectPool() {}
 
-	void for_each(void(*function)(std::shared_ptr<ObjectType>))
-	{
-		for (size_t i = pool_bottom; i != pool_top; i = (i + 1) % PoolSize)
-		{
-			function(pool[i]);
-		}
-	}
-
-	
 	virtual void push(std::shared_ptr<ObjectType> object)
 	{
-		std::lock_guard lock(pool_lock);
-		if ((pool_bottom + 1) % PoolSize == pool_top)
-		{ LOG_FATAL("object pool overflow : max=%d", PoolSize);
-		}
-		
-		pool[pool_bottom] = object;
-		pool_bottom = (pool_bottom + 1) % PoolSize;
+		pool.push(std::move(object));
 	}
 
 	virtual std::shared_ptr<ObjectType> pop()
 	{
-		std::lock_guard lock(pool_lock);
-		if (is_empty()) return nullptr;
-
-		std::shared_ptr<ObjectType> object = pool[pool_top];
-		pool[pool_top] = nullptr;
-		pool_top = (pool_top + 1) % PoolSize;
-		
+		std::shared_ptr<ObjectType> object;
+		pool.pop(object);
 		return object;
 	}
 
-	[[nodiscard]] bool is_empty() const { return pool_top == pool_bottom; }
+	[[nodiscard]] bool is_empty() const { return pool.is_empty(); }
 	
 private:
 
-	std::vector<std::shared_ptr<ObjectType>> pool;
-	//std::shared_ptr<ObjectType>* pool = nullptr;
-	std::mutex pool_lock;
-	long pool_top = 0;
-	long pool_bottom = 0;
-};
\ No newline at end of file
+	TMpmcQueue<std::shared_ptr<ObjectType>, std::bit_ceil(PoolSize > 2 ? PoolSize : 2)> pool;
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * Generational handle to an object of a TSlotMap. A handle stays valid until its object is erased, then never matches another object.
+ * Fits in 64 bits (see pack / unpack) to be stored in opaque ids.
+ */
+struct SlotHandle
+{
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+	uint32_t index = INVALID_INDEX;
+	uint32_t generation = 0;
+
+	[[nodiscard]] bool is_valid() const { return index != INVALID_INDEX; }
+	[[nodiscard]] uint64_t pack() const { return static_cast<uint64_t>(generation) << 32 | index; }
+	[[nodiscard]] static SlotHandle unpack(uint64_t packed) { return SlotHandle{.index = static_cast<uint32_t>(packed), .generation = static_cast<uint32_t>(packed >> 32)}; }
+
+	bool operator==(const SlotHandle& other) const = default;
+};
+
+/**
+ * Objects addressed by generational handles, stored densely : insert, erase and lookup are O(1), and iterating runs over a contiguous array.
+ * Erasing moves the last object in place of the erased one : object addresses and dense order are not stable, handles are.
+ */
+template<typename ObjectType, typename Allocator = std::allocator<ObjectType>>
+class TSlotMap final
+{
+	template<typename Type>
+	using TRebind = typename std::allocator_traits<Allocator>::template rebind_alloc<Type>;
+
+public:
+	using Handle = SlotHandle;
+
+	template<typename... Args>
+	Handle emplace(Args&&... args)
+	{
+		uint32_t slot_index;
+		if (free_head != NO_SLOT)
+		{
+			slot_index = free_head;
+			free_head = slots[slot_index].dense_index;
+		}
+		else
+		{
+			slot_index = static_cast<uint32_t>(slots.size());
+			slots.emplace_back();
+		}
+
+		objects.emplace_back(std::forward<Args>(args)...);
+		dense_to_slot.emplace_back(slot_index);
+		Slot& slot = slots[slot_index];
+		slot.dense_index = static_cast<uint32_t>(objects.size() - 1);
+		return Handle{.index = slot_index, .generation = slot.generation};
+	}
+
+	Handle insert(ObjectType object) { return emplace(std::move(object)); }
+
+	/** Returns false if the handle doesn't point to a living object */
+	bool erase(Handle handle)
+	{
+		if (!contains(handle))
+			return false;
+
+		Slot& slot = slots[handle.index];
+		const uint32_t dense_index = slot.dense_index;
+		const uint32_t last_index = static_cast<uint32_t>(objects.size() - 1);
+		if (dense_index != last_index)
+		{
+			objects[dense_index] = std::move(objects[last_index]);
+			dense_to_slot[dense_index] = dense_to_slot[last_index];
+			slots[dense_to_slot[dense_index]].dense_index = dense_index;
+		}
+		objects.pop_back();
+		dense_to_slot.pop_back();
+
+		// Outdate every handle to this slot, then recycle it
+		++slot.generation;
+		slot.dense_index = free_head;
+		free_head = handle.index;
+		return true;
+	}
+
+	[[nodiscard]] bool contains(Handle handle) const
+	{
+		// Free slots have a greater generation than any handle given for them
+		return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+	}
+
+	/** nullptr if the handle doesn't point to a living object */
+	[[nodiscard]] ObjectType* get(Handle handle) { return contains(handle) ? &objects[slots[handle.index].dense_index] : nullptr; }
+	[[nodiscard]] const ObjectType* get(Handle handle) const { return contains(handle) ? &objects[slots[handle.index].dense_index] : nullptr; }
+
+	/** Handle of the object at index in the dense array */
+	[[nodiscard]] Handle get_handle(size_t dense_index) const
+	{
+		const uint32_t slot_index = dense_to_slot[dense_index];
+		return Handle{.index = slot_index, .generation = slots[slot_index].generation};
+	}
+
+	void reserve(size_t count)
+	{
+		objects.reserve(count);
+		dense_to_slot.reserve(count);
+		slots.reserve(count);
+	}
+
+	/** Erase every object. Existing handles are outdated */
+	void clear()
+	{
+		for (const uint32_t slot_index : dense_to_slot)
+		{
+			Slot& slot = slots[slot_index];
+			++slot.generation;
+			slot.dense_index = free_head;
+			free_head = slot_index;
+		}
+		objects.clear();
+		dense_to_slot.clear();
+	}
+
+	[[nodiscard]] size_t size() const { return objects.size(); }
+	[[nodiscard]] bool empty() const { return objects.empty(); }
+
+	[[nodiscard]] ObjectType* data() { return objects.data(); }
+	[[nodiscard]] const ObjectType* data() const { return objects.data(); }
+	[[nodiscard]] ObjectType& operator[](size_t dense_index) { return objects[dense_index]; }
+	[[nodiscard]] const ObjectType& operator[](size_t dense_index) const { return objects[dense_index]; }
+
+	auto begin() { return objects.begin(); }
+	auto end() { return objects.end(); }
+	auto begin() const { return objects.begin(); }
+	auto end() const { return objects.end(); }
+
+private:
+	static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+	struct Slot
+	{
+		uint32_t dense_index = NO_SLOT; // Next free slot while the slot is free
+		uint32_t generation = 0;
+	};
+
+	std::vector<ObjectType, Allocator> objects;
+	std::vector<uint32_t, TRebind<uint32_t>> dense_to_slot;
+	std::vector<Slot, TRebind<Slot>> slots;
+	uint32_t free_head = NO_SLOT;
+};
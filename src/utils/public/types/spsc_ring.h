@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * Bounded single producer / single consumer ring buffer. Storage is allocated once : push and pop never allocate nor lock.
+ * Capacity must be a power of two.
+ */
+template<typename ObjectType, size_t Capacity>
+class TSpscRing final
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "ring capacity must be a power of two");
+
+public:
+	TSpscRing() : slots(std::make_unique<ObjectType[]>(Capacity)) {}
+
+	TSpscRing(const TSpscRing&) = delete;
+	TSpscRing& operator=(const TSpscRing&) = delete;
+
+	/** Producer side. Returns false when the ring is full */
+	bool push(const ObjectType& object)
+	{
+		const size_t write = write_index.load(std::memory_order_relaxed);
+		if (write - read_index.load(std::memory_order_acquire) == Capacity)
+			return false;
+		slots[write & (Capacity - 1)] = object;
+		write_index.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Consumer side. Calls function on every available object, in push order, then frees their slots. Returns the number of objects consumed */
+	template<typename Function>
+	size_t consume_all(Function&& function)
+	{
+		const size_t read = read_index.load(std::memory_order_relaxed);
+		const size_t write = write_index.load(std::memory_order_acquire);
+		for (size_t i = read; i != write; ++i)
+			function(slots[i & (Capacity - 1)]);
+		read_index.store(write, std::memory_order_release);
+		return write - read;
+	}
+
+	[[nodiscard]] static constexpr size_t capacity() { return Capacity; }
+
+private:
+	std::unique_ptr<ObjectType[]> slots;
+	// Each index is written by a single side : keep them on separate cache lines
+	alignas(64) std::atomic_size_t write_index = 0;
+	alignas(64) std::atomic_size_t read_index = 0;
+};